@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace Nyx
+{
+    namespace Core
+    {
+        constexpr uint64_t kFNVOffsetBasis = 14695981039346656037ull;
+        constexpr uint64_t kFNVPrime = 1099511628211ull;
+
+        // FNV-1a over a string. constexpr so names can be hashed at compile time.
+        constexpr uint64_t HashString(std::string_view str, uint64_t seed = kFNVOffsetBasis)
+        {
+            uint64_t hash = seed;
+            for (char c : str)
+            {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= kFNVPrime;
+            }
+            return hash;
+        }
+
+        // FNV-1a style hash that consumes 8 bytes per step, used for hashing whole files.
+        inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = kFNVOffsetBasis)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            uint64_t hash = seed;
+
+            size_t words = size / sizeof(uint64_t);
+            for (size_t i = 0; i < words; ++i)
+            {
+                uint64_t word;
+                std::memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+                hash ^= word;
+                hash *= kFNVPrime;
+                hash ^= hash >> 32;
+            }
+
+            for (size_t i = words * sizeof(uint64_t); i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= kFNVPrime;
+            }
+            return hash;
+        }
+
+        inline uint64_t HashCombine(uint64_t hash, uint64_t value)
+        {
+            return HashBytes(&value, sizeof(value), hash);
+        }
+    }
+}
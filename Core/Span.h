@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace Nyx
+{
+    namespace Core
+    {
+        // Pointer and size view over contiguous elements owned elsewhere, the subset of C++20's
+        // std::span that Nyx needs while staying on C++17. Span<T> converts to Span<const T>, and
+        // vectors convert to spans of their elements.
+        template<typename T>
+        class Span
+        {
+        public:
+            using element_type = T;
+            using value_type = std::remove_cv_t<T>;
+            using iterator = T*;
+
+            constexpr Span() = default;
+            constexpr Span(T* data, size_t size) : m_Data(data), m_Size(size) {}
+
+            template<typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+            constexpr Span(const Span<U>& other) : m_Data(other.data()), m_Size(other.size()) {}
+
+            template<typename Allocator>
+            Span(std::vector<value_type, Allocator>& vector) : m_Data(vector.data()), m_Size(vector.size()) {}
+
+            template<typename Allocator, typename U = T, typename = std::enable_if_t<std::is_const_v<U>>>
+            Span(const std::vector<value_type, Allocator>& vector) : m_Data(vector.data()), m_Size(vector.size()) {}
+
+            constexpr T* data() const { return m_Data; }
+            constexpr size_t size() const { return m_Size; }
+            constexpr bool empty() const { return m_Size == 0; }
+
+            constexpr T& operator[](size_t index) const { return m_Data[index]; }
+            constexpr T* begin() const { return m_Data; }
+            constexpr T* end() const { return m_Data + m_Size; }
+
+            // The first count elements; count must not exceed size()
+            constexpr Span first(size_t count) const { return Span(m_Data, count); }
+            constexpr Span subspan(size_t offset, size_t count) const { return Span(m_Data + offset, count); }
+
+        private:
+            T* m_Data = nullptr;
+            size_t m_Size = 0;
+        };
+    }
+}
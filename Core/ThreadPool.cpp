@@ -0,0 +1,131 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <exception>
+
+namespace Nyx
+{
+    namespace Core
+    {
+        ThreadPool::ThreadPool(unsigned int threadCount)
+        {
+            if (threadCount == 0)
+            {
+                unsigned int hardware = std::thread::hardware_concurrency();
+                threadCount = hardware > 1 ? hardware - 1 : 1;
+            }
+
+            m_Workers.reserve(threadCount);
+            for (unsigned int i = 0; i < threadCount; ++i)
+                m_Workers.emplace_back([this]() { workerLoop(); });
+        }
+
+        ThreadPool::~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Stopping = true;
+            }
+            m_Condition.notify_all();
+            for (std::thread& worker : m_Workers)
+                worker.join();
+        }
+
+        void ThreadPool::enqueue(std::function<void()> task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Tasks.push_back(std::move(task));
+            }
+            m_Condition.notify_one();
+        }
+
+        void ThreadPool::workerLoop()
+        {
+            for (;;)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_Condition.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+                    if (m_Stopping && m_Tasks.empty())
+                        return;
+                    task = std::move(m_Tasks.front());
+                    m_Tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+        {
+            if (count == 0)
+                return;
+            if (count == 1)
+            {
+                fn(0);
+                return;
+            }
+
+            // Shared so helpers that only get scheduled after we return still see valid state.
+            struct State
+            {
+                std::function<void(size_t)> fn;
+                size_t count;
+                std::atomic<size_t> next{ 0 };
+                std::atomic<size_t> done{ 0 };
+                std::atomic<bool> failed{ false };
+                std::exception_ptr error;   // First exception thrown by fn, guarded by mutex
+                std::mutex mutex;
+                std::condition_variable finished;
+            };
+            auto state = std::make_shared<State>();
+            state->fn = fn;
+            state->count = count;
+
+            auto run = [](State& s) {
+                size_t i;
+                while ((i = s.next.fetch_add(1)) < s.count)
+                {
+                    // An index that throws still counts as done, or the caller would wait forever.
+                    // Once one has failed the rest are skipped.
+                    if (!s.failed.load())
+                    {
+                        try
+                        {
+                            s.fn(i);
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(s.mutex);
+                            if (!s.error)
+                                s.error = std::current_exception();
+                            s.failed.store(true);
+                        }
+                    }
+                    if (s.done.fetch_add(1) + 1 == s.count)
+                    {
+                        std::lock_guard<std::mutex> lock(s.mutex);
+                        s.finished.notify_all();
+                    }
+                }
+            };
+
+            size_t helpers = std::min<size_t>(m_Workers.size(), count - 1);
+            for (size_t i = 0; i < helpers; ++i)
+                enqueue([state, run]() { run(*state); });
+
+            run(*state);
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->finished.wait(lock, [&]() { return state->done.load() == state->count; });
+            if (state->error)
+                std::rethrow_exception(state->error);
+        }
+
+        ThreadPool& ThreadPool::GetShared()
+        {
+            static ThreadPool pool;
+            return pool;
+        }
+    }
+}
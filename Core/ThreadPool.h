@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Nyx
+{
+    namespace Core
+    {
+        // Fixed-size worker pool used by the loaders for CPU-side work. Never touches GL.
+        class NYX_API ThreadPool
+        {
+        public:
+            // 0 picks hardware_concurrency() - 1 workers (at least one).
+            explicit ThreadPool(unsigned int threadCount = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            template<typename F>
+            auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+            {
+                using Result = std::invoke_result_t<std::decay_t<F>>;
+                auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+                std::future<Result> future = packaged->get_future();
+                enqueue([packaged]() { (*packaged)(); });
+                return future;
+            }
+
+            // Runs fn(i) for every i in [0, count). The calling thread takes part, so this is safe
+            // to call from inside a worker task. If fn throws, the remaining indices are skipped and the
+            // first exception is rethrown on the caller once every worker has let go of the loop.
+            void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+            inline unsigned int getThreadCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+
+            // Process-wide pool shared by the loaders.
+            static ThreadPool& GetShared();
+
+        private:
+            void enqueue(std::function<void()> task);
+            void workerLoop();
+
+        private:
+            std::vector<std::thread> m_Workers;
+            std::deque<std::function<void()>> m_Tasks;
+            std::mutex m_Mutex;
+            std::condition_variable m_Condition;
+            bool m_Stopping = false;
+        };
+    }
+}
@@ -0,0 +1,218 @@
+#include "Bounds.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        namespace
+        {
+            inline const float* At(const float* positions, size_t index, size_t stride)
+            {
+                return reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + index * stride);
+            }
+
+            inline float DistanceSq(const float* a, const float* b)
+            {
+                float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+                return dx * dx + dy * dy + dz * dz;
+            }
+        }
+
+        Frustum Frustum::FromViewProjection(const float* m)
+        {
+            Frustum frustum;
+            for (int i = 0; i < 4; ++i)
+            {
+                float row0 = m[i * 4 + 0], row1 = m[i * 4 + 1], row2 = m[i * 4 + 2], row3 = m[i * 4 + 3];
+                frustum.planes[Left][i]   = row3 + row0;
+                frustum.planes[Right][i]  = row3 - row0;
+                frustum.planes[Bottom][i] = row3 + row1;
+                frustum.planes[Top][i]    = row3 - row1;
+                frustum.planes[Near][i]   = row3 + row2;
+                frustum.planes[Far][i]    = row3 - row2;
+            }
+
+            for (auto& plane : frustum.planes)
+            {
+                float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+                if (length > 0.0f)
+                {
+                    for (float& value : plane)
+                        value /= length;
+                }
+            }
+            return frustum;
+        }
+
+        bool Frustum::intersects(const BoundingSphere& sphere) const
+        {
+            for (const auto& plane : planes)
+            {
+                float distance = plane[0] * sphere.center[0] + plane[1] * sphere.center[1] +
+                                 plane[2] * sphere.center[2] + plane[3];
+                if (distance < -sphere.radius)
+                    return false;
+            }
+            return true;
+        }
+
+        bool Frustum::intersects(const AABB& box) const
+        {
+            for (const auto& plane : planes)
+            {
+                // Corner furthest along the plane normal
+                float x = plane[0] >= 0.0f ? box.max[0] : box.min[0];
+                float y = plane[1] >= 0.0f ? box.max[1] : box.min[1];
+                float z = plane[2] >= 0.0f ? box.max[2] : box.min[2];
+                if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f)
+                    return false;
+            }
+            return true;
+        }
+
+        BoundingSphere ComputeBoundingSphere(const float* positions, size_t count, size_t stride)
+        {
+            BoundingSphere sphere;
+            if (count == 0)
+                return sphere;
+
+            // Find the point furthest from an arbitrary point, then the point furthest from that one
+            const float* a = At(positions, 0, stride);
+            const float* b = a;
+            float best = 0.0f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                float d = DistanceSq(a, At(positions, i, stride));
+                if (d > best) { best = d; b = At(positions, i, stride); }
+            }
+            const float* c = b;
+            best = 0.0f;
+            for (size_t i = 0; i < count; ++i)
+            {
+                float d = DistanceSq(b, At(positions, i, stride));
+                if (d > best) { best = d; c = At(positions, i, stride); }
+            }
+
+            for (int k = 0; k < 3; ++k)
+                sphere.center[k] = (b[k] + c[k]) * 0.5f;
+            sphere.radius = std::sqrt(best) * 0.5f;
+
+            // Grow the sphere to enclose every point
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float* p = At(positions, i, stride);
+                float d2 = DistanceSq(p, sphere.center);
+                if (d2 > sphere.radius * sphere.radius)
+                {
+                    float d = std::sqrt(d2);
+                    float newRadius = (sphere.radius + d) * 0.5f;
+                    float k = (newRadius - sphere.radius) / d;
+                    for (int j = 0; j < 3; ++j)
+                        sphere.center[j] += (p[j] - sphere.center[j]) * k;
+                    sphere.radius = newRadius;
+                }
+            }
+            return sphere;
+        }
+
+        AABB ComputeAABB(const float* positions, size_t count, size_t stride)
+        {
+            AABB box;
+            if (count == 0)
+                return box;
+
+            const float* first = At(positions, 0, stride);
+            for (int k = 0; k < 3; ++k)
+                box.min[k] = box.max[k] = first[k];
+            for (size_t i = 1; i < count; ++i)
+            {
+                const float* p = At(positions, i, stride);
+                for (int k = 0; k < 3; ++k)
+                {
+                    box.min[k] = std::min(box.min[k], p[k]);
+                    box.max[k] = std::max(box.max[k], p[k]);
+                }
+            }
+            return box;
+        }
+
+        Bounds ComputeBounds(const float* positions, size_t count, size_t stride)
+        {
+            Bounds bounds;
+            bounds.box = ComputeAABB(positions, count, stride);
+            bounds.sphere = ComputeBoundingSphere(positions, count, stride);
+
+            float halfExtent[3];
+            BoundingSphere boxSphere;
+            for (int k = 0; k < 3; ++k)
+            {
+                boxSphere.center[k] = (bounds.box.min[k] + bounds.box.max[k]) * 0.5f;
+                halfExtent[k] = (bounds.box.max[k] - bounds.box.min[k]) * 0.5f;
+            }
+            boxSphere.radius = std::sqrt(halfExtent[0] * halfExtent[0] + halfExtent[1] * halfExtent[1] +
+                                         halfExtent[2] * halfExtent[2]);
+            if (boxSphere.radius < bounds.sphere.radius)
+                bounds.sphere = boxSphere;
+            return bounds;
+        }
+
+        Bounds MergeBounds(const Bounds& a, const Bounds& b)
+        {
+            Bounds merged;
+            for (int k = 0; k < 3; ++k)
+            {
+                merged.box.min[k] = std::min(a.box.min[k], b.box.min[k]);
+                merged.box.max[k] = std::max(a.box.max[k], b.box.max[k]);
+            }
+
+            float distance = std::sqrt(DistanceSq(a.sphere.center, b.sphere.center));
+            if (distance + b.sphere.radius <= a.sphere.radius)
+                merged.sphere = a.sphere;
+            else if (distance + a.sphere.radius <= b.sphere.radius)
+                merged.sphere = b.sphere;
+            else
+            {
+                merged.sphere.radius = (distance + a.sphere.radius + b.sphere.radius) * 0.5f;
+                float t = (merged.sphere.radius - a.sphere.radius) / distance;
+                for (int k = 0; k < 3; ++k)
+                    merged.sphere.center[k] = a.sphere.center[k] + (b.sphere.center[k] - a.sphere.center[k]) * t;
+            }
+            return merged;
+        }
+
+        BoundingSphere TransformSphere(const BoundingSphere& sphere, const float* m)
+        {
+            BoundingSphere transformed;
+            float maxScaleSq = 0.0f;
+            for (int k = 0; k < 3; ++k)
+            {
+                transformed.center[k] = m[12 + k] + m[k] * sphere.center[0] + m[4 + k] * sphere.center[1] + m[8 + k] * sphere.center[2];
+                const float* axis = m + k * 4;
+                maxScaleSq = std::max(maxScaleSq, axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+            }
+            transformed.radius = sphere.radius * std::sqrt(maxScaleSq);
+            return transformed;
+        }
+
+        Bounds TransformBounds(const Bounds& bounds, const float* m)
+        {
+            // Arvo: each output extent is the translation plus the smaller/larger product per input axis
+            Bounds transformed;
+            for (int row = 0; row < 3; ++row)
+            {
+                transformed.box.min[row] = transformed.box.max[row] = m[12 + row];
+                for (int column = 0; column < 3; ++column)
+                {
+                    float a = m[column * 4 + row] * bounds.box.min[column];
+                    float b = m[column * 4 + row] * bounds.box.max[column];
+                    transformed.box.min[row] += std::min(a, b);
+                    transformed.box.max[row] += std::max(a, b);
+                }
+            }
+            transformed.sphere = TransformSphere(bounds.sphere, m);
+            return transformed;
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include <cstddef>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        struct NYX_API BoundingSphere
+        {
+            float center[3] = { 0.0f, 0.0f, 0.0f };
+            float radius = 0.0f;
+        };
+
+        struct NYX_API AABB
+        {
+            float min[3] = { 0.0f, 0.0f, 0.0f };
+            float max[3] = { 0.0f, 0.0f, 0.0f };
+        };
+
+        // Box and sphere of the same geometry: the box is tighter, the sphere is cheaper to test.
+        struct NYX_API Bounds
+        {
+            AABB box;
+            BoundingSphere sphere;
+        };
+
+        // Six normalized planes (a, b, c, d) with a*x + b*y + c*z + d >= 0 on the inside.
+        struct NYX_API Frustum
+        {
+            enum Plane { Left = 0, Right, Bottom, Top, Near, Far };
+            float planes[6][4] = {};
+
+            // Extracts the planes from a column-major (OpenGL/GLM) view-projection matrix.
+            // Pass projection * view * model to get the frustum in that model's local space.
+            static Frustum FromViewProjection(const float* matrix);
+
+            bool intersects(const BoundingSphere& sphere) const;
+            bool intersects(const AABB& box) const;
+        };
+
+        // Ritter's approximate bounding sphere. positions points at the first float of the first
+        // position, stride is the distance in bytes between consecutive positions.
+        NYX_API BoundingSphere ComputeBoundingSphere(const float* positions, size_t count, size_t stride);
+
+        NYX_API AABB ComputeAABB(const float* positions, size_t count, size_t stride);
+
+        // Box plus the smaller of Ritter's sphere and the sphere around the box.
+        NYX_API Bounds ComputeBounds(const float* positions, size_t count, size_t stride);
+
+        // Smallest box and (approximately) smallest sphere enclosing both inputs.
+        NYX_API Bounds MergeBounds(const Bounds& a, const Bounds& b);
+
+        // Bounds after a column-major affine transform such as a model matrix: local to world space.
+        // The box is the AABB of the transformed box, the sphere radius grows by the largest axis scale.
+        NYX_API BoundingSphere TransformSphere(const BoundingSphere& sphere, const float* matrix);
+        NYX_API Bounds TransformBounds(const Bounds& bounds, const float* matrix);
+    }
+}
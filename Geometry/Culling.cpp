@@ -0,0 +1,141 @@
+#include "Culling.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define NYX_CULL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NYX_CULL_SSE
+#endif
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        namespace
+        {
+            size_t CullRange(const Frustum& frustum, const SphereBatch& spheres, uint8_t* visibility,
+                             size_t begin, size_t end)
+            {
+                size_t visible = 0;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    BoundingSphere sphere;
+                    sphere.center[0] = spheres.centerX[i];
+                    sphere.center[1] = spheres.centerY[i];
+                    sphere.center[2] = spheres.centerZ[i];
+                    sphere.radius = spheres.radius[i];
+                    visibility[i] = frustum.intersects(sphere) ? 1 : 0;
+                    visible += visibility[i];
+                }
+                return visible;
+            }
+        }
+
+        void SphereBatch::clear()
+        {
+            centerX.clear();
+            centerY.clear();
+            centerZ.clear();
+            radius.clear();
+        }
+
+        void SphereBatch::reserve(size_t count)
+        {
+            centerX.reserve(count);
+            centerY.reserve(count);
+            centerZ.reserve(count);
+            radius.reserve(count);
+        }
+
+        void SphereBatch::push(const BoundingSphere& sphere)
+        {
+            centerX.push_back(sphere.center[0]);
+            centerY.push_back(sphere.center[1]);
+            centerZ.push_back(sphere.center[2]);
+            radius.push_back(sphere.radius);
+        }
+
+        size_t CullSpheresScalar(const Frustum& frustum, const SphereBatch& spheres, uint8_t* visibility)
+        {
+            return CullRange(frustum, spheres, visibility, 0, spheres.size());
+        }
+
+        size_t CullSpheres(const Frustum& frustum, const SphereBatch& spheres, uint8_t* visibility)
+        {
+            const size_t count = spheres.size();
+            const float* xs = spheres.centerX.data();
+            const float* ys = spheres.centerY.data();
+            const float* zs = spheres.centerZ.data();
+            const float* rs = spheres.radius.data();
+            size_t visible = 0;
+            size_t i = 0;
+
+#if defined(NYX_CULL_AVX)
+            __m256 planes[6][4];
+            for (int p = 0; p < 6; ++p)
+                for (int k = 0; k < 4; ++k)
+                    planes[p][k] = _mm256_set1_ps(frustum.planes[p][k]);
+
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 x = _mm256_loadu_ps(xs + i);
+                __m256 y = _mm256_loadu_ps(ys + i);
+                __m256 z = _mm256_loadu_ps(zs + i);
+                __m256 r = _mm256_loadu_ps(rs + i);
+
+                // Inside every plane: a*x + b*y + c*z + d >= -r, evaluated in the same order as Frustum::intersects
+                __m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), r);
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for (int p = 0; p < 6; ++p)
+                {
+                    __m256 distance = _mm256_add_ps(_mm256_mul_ps(planes[p][0], x), _mm256_mul_ps(planes[p][1], y));
+                    distance = _mm256_add_ps(distance, _mm256_mul_ps(planes[p][2], z));
+                    distance = _mm256_add_ps(distance, planes[p][3]);
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negR, _CMP_GE_OQ));
+                }
+
+                int mask = _mm256_movemask_ps(inside);
+                for (int k = 0; k < 8; ++k)
+                {
+                    visibility[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+                    visible += (mask >> k) & 1;
+                }
+            }
+#elif defined(NYX_CULL_SSE)
+            __m128 planes[6][4];
+            for (int p = 0; p < 6; ++p)
+                for (int k = 0; k < 4; ++k)
+                    planes[p][k] = _mm_set1_ps(frustum.planes[p][k]);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 x = _mm_loadu_ps(xs + i);
+                __m128 y = _mm_loadu_ps(ys + i);
+                __m128 z = _mm_loadu_ps(zs + i);
+                __m128 r = _mm_loadu_ps(rs + i);
+
+                __m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int p = 0; p < 6; ++p)
+                {
+                    __m128 distance = _mm_add_ps(_mm_mul_ps(planes[p][0], x), _mm_mul_ps(planes[p][1], y));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(planes[p][2], z));
+                    distance = _mm_add_ps(distance, planes[p][3]);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negR));
+                }
+
+                int mask = _mm_movemask_ps(inside);
+                for (int k = 0; k < 4; ++k)
+                {
+                    visibility[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+                    visible += (mask >> k) & 1;
+                }
+            }
+#endif
+
+            // Remainder, or everything when no SIMD path is available
+            return visible + CullRange(frustum, spheres, visibility, i, count);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "Bounds.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        // Bounding spheres in structure-of-arrays layout, so several can be tested per SIMD instruction.
+        struct NYX_API SphereBatch
+        {
+            std::vector<float> centerX;
+            std::vector<float> centerY;
+            std::vector<float> centerZ;
+            std::vector<float> radius;
+
+            void clear();
+            void reserve(size_t count);
+            void push(const BoundingSphere& sphere);
+            inline size_t size() const { return radius.size(); }
+        };
+
+        // Writes 1 to visibility[i] if sphere i intersects the frustum and 0 otherwise.
+        // Returns the number of visible spheres. Uses AVX or SSE when the build enables them.
+        NYX_API size_t CullSpheres(const Frustum& frustum, const SphereBatch& spheres, uint8_t* visibility);
+
+        // Reference implementation, one sphere at a time through Frustum::intersects.
+        NYX_API size_t CullSpheresScalar(const Frustum& frustum, const SphereBatch& spheres, uint8_t* visibility);
+    }
+}
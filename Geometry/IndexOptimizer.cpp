@@ -0,0 +1,511 @@
+#include "IndexOptimizer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        namespace
+        {
+            constexpr uint32_t kInvalid = UINT32_MAX;
+
+            struct TriangleAdjacency
+            {
+                std::vector<uint32_t> offsets;   // Per vertex, into triangles
+                std::vector<uint32_t> triangles;
+            };
+
+            TriangleAdjacency BuildAdjacency(Core::Span<const unsigned int> indices, size_t triangleCount, size_t vertexCount)
+            {
+                TriangleAdjacency adjacency;
+                adjacency.offsets.assign(vertexCount + 1, 0);
+                for (size_t i = 0; i < triangleCount * 3; ++i)
+                    ++adjacency.offsets[indices[i] + 1];
+                for (size_t i = 0; i < vertexCount; ++i)
+                    adjacency.offsets[i + 1] += adjacency.offsets[i];
+
+                adjacency.triangles.resize(triangleCount * 3);
+                std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+                for (size_t i = 0; i < triangleCount * 3; ++i)
+                    adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+                return adjacency;
+            }
+
+            // FIFO cache using timestamps: a vertex is resident while fewer than size misses happened since it was loaded.
+            struct CacheSimulator
+            {
+                std::vector<uint32_t> timestamps;
+                uint32_t time;
+                uint32_t size;
+
+                CacheSimulator(size_t vertexCount, uint32_t cacheSize)
+                    : timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+                bool access(unsigned int vertex)
+                {
+                    if (time - timestamps[vertex] <= size)
+                        return true;
+                    timestamps[vertex] = time++;
+                    return false;
+                }
+
+                unsigned int accessTriangle(const unsigned int* triangle)
+                {
+                    return !access(triangle[0]) + !access(triangle[1]) + !access(triangle[2]);
+                }
+
+                void flush() { time += size + 1; }
+            };
+
+            size_t MaxIndex(Core::Span<const unsigned int> indices)
+            {
+                unsigned int maxIndex = 0;
+                for (unsigned int index : indices)
+                    maxIndex = std::max(maxIndex, index);
+                return indices.empty() ? 0 : size_t(maxIndex) + 1;
+            }
+
+            struct ScreenVertex
+            {
+                float x, y, z;
+            };
+
+            // Edge function, positive when p is to the left of a -> b
+            inline float Edge(const ScreenVertex& a, const ScreenVertex& b, float px, float py)
+            {
+                return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+            }
+
+            // Top-left fill rule so shared edges are rasterized exactly once
+            inline bool IsTopLeft(const ScreenVertex& a, const ScreenVertex& b)
+            {
+                return (a.y == b.y && b.x < a.x) || b.y > a.y;
+            }
+
+            inline bool Inside(float w, bool topLeft)
+            {
+                return w > 0.0f || (w == 0.0f && topLeft);
+            }
+
+            constexpr int kOverdrawGrid = 256;
+
+            void RasterizeTriangle(ScreenVertex a, ScreenVertex b, ScreenVertex c, std::vector<float>& depth, size_t& shaded)
+            {
+                float area = Edge(a, b, c.x, c.y);
+                if (area == 0.0f)
+                    return;
+                if (area < 0.0f)
+                {
+                    std::swap(b, c);
+                    area = -area;
+                }
+
+                int minX = std::max(0, static_cast<int>(std::floor(std::min({ a.x, b.x, c.x }))));
+                int minY = std::max(0, static_cast<int>(std::floor(std::min({ a.y, b.y, c.y }))));
+                int maxX = std::min(kOverdrawGrid - 1, static_cast<int>(std::ceil(std::max({ a.x, b.x, c.x }))));
+                int maxY = std::min(kOverdrawGrid - 1, static_cast<int>(std::ceil(std::max({ a.y, b.y, c.y }))));
+
+                const bool topLeftA = IsTopLeft(b, c), topLeftB = IsTopLeft(c, a), topLeftC = IsTopLeft(a, b);
+                const float invArea = 1.0f / area;
+
+                for (int y = minY; y <= maxY; ++y)
+                {
+                    float py = y + 0.5f;
+                    for (int x = minX; x <= maxX; ++x)
+                    {
+                        float px = x + 0.5f;
+                        float wa = Edge(b, c, px, py);
+                        float wb = Edge(c, a, px, py);
+                        float wc = Edge(a, b, px, py);
+                        if (!Inside(wa, topLeftA) || !Inside(wb, topLeftB) || !Inside(wc, topLeftC))
+                            continue;
+
+                        float z = (wa * a.z + wb * b.z + wc * c.z) * invArea;
+                        float& stored = depth[y * kOverdrawGrid + x];
+                        if (z < stored)
+                        {
+                            stored = z;
+                            ++shaded;
+                        }
+                    }
+                }
+            }
+        }
+
+        void OptimizeVertexCache(Core::Span<unsigned int> indices, size_t vertexCount, unsigned int cacheSize)
+        {
+            const size_t triangleCount = indices.size() / 3;
+            if (triangleCount == 0 || vertexCount == 0)
+                return;
+
+            TriangleAdjacency adjacency = BuildAdjacency(indices, triangleCount, vertexCount);
+
+            std::vector<uint32_t> liveTriangles(vertexCount, 0);
+            for (size_t i = 0; i < triangleCount * 3; ++i)
+                ++liveTriangles[indices[i]];
+
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> timestamps(vertexCount, 0);
+            std::vector<uint32_t> deadEnd;          // Recently used vertices, for when a fan runs dry
+            deadEnd.reserve(triangleCount * 3);
+            std::vector<uint32_t> candidates;
+
+            std::vector<unsigned int> reordered;
+            reordered.reserve(indices.size());
+
+            uint32_t time = cacheSize + 1;
+            size_t scanCursor = 0;
+            uint32_t fanning = indices[0];
+
+            while (fanning != kInvalid)
+            {
+                // Emit every remaining triangle around the fanning vertex
+                candidates.clear();
+                for (uint32_t a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a)
+                {
+                    uint32_t triangle = adjacency.triangles[a];
+                    if (emitted[triangle])
+                        continue;
+                    emitted[triangle] = true;
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        unsigned int v = indices[triangle * 3 + k];
+                        reordered.push_back(v);
+                        deadEnd.push_back(v);
+                        candidates.push_back(v);
+                        --liveTriangles[v];
+                        if (time - timestamps[v] > cacheSize)
+                            timestamps[v] = time++;
+                    }
+                }
+
+                // Next fan: the candidate that has been in the cache longest but will still be resident
+                // after its remaining triangles are emitted
+                uint32_t next = kInvalid;
+                int64_t bestPriority = -1;
+                for (uint32_t v : candidates)
+                {
+                    if (liveTriangles[v] == 0)
+                        continue;
+                    int64_t age = int64_t(time) - timestamps[v];
+                    int64_t priority = age + 2 * int64_t(liveTriangles[v]) <= cacheSize ? age : 0;
+                    if (priority > bestPriority)
+                    {
+                        bestPriority = priority;
+                        next = v;
+                    }
+                }
+
+                if (next == kInvalid)
+                {
+                    while (!deadEnd.empty())
+                    {
+                        uint32_t v = deadEnd.back();
+                        deadEnd.pop_back();
+                        if (liveTriangles[v] > 0)
+                        {
+                            next = v;
+                            break;
+                        }
+                    }
+                }
+                if (next == kInvalid)
+                {
+                    while (scanCursor < vertexCount && liveTriangles[scanCursor] == 0)
+                        ++scanCursor;
+                    if (scanCursor < vertexCount)
+                        next = static_cast<uint32_t>(scanCursor);
+                }
+                fanning = next;
+            }
+
+            // Keep any trailing non-triangle indices so the index count never changes
+            reordered.insert(reordered.end(), indices.begin() + triangleCount * 3, indices.end());
+            std::copy(reordered.begin(), reordered.end(), indices.begin());
+        }
+
+        void OptimizeOverdraw(const Mesh& mesh, Core::Span<unsigned int> indices, float threshold, unsigned int cacheSize)
+        {
+            const size_t triangleCount = indices.size() / 3;
+            if (triangleCount == 0 || mesh.vertices.empty())
+                return;
+
+            // Hard boundaries: triangles where the cache was effectively flushed (all three vertices missed)
+            CacheSimulator cache(mesh.vertices.size(), cacheSize);
+            std::vector<uint32_t> hardClusters;
+            for (size_t t = 0; t < triangleCount; ++t)
+            {
+                if (cache.accessTriangle(&indices[t * 3]) == 3 || t == 0)
+                    hardClusters.push_back(static_cast<uint32_t>(t));
+            }
+            hardClusters.push_back(static_cast<uint32_t>(triangleCount));
+
+            // Soft boundaries: split hard clusters further wherever the running ACMR is already
+            // within threshold of the cluster's own ACMR, so reordering costs little cache efficiency
+            std::vector<uint32_t> clusters;
+            for (size_t h = 0; h + 1 < hardClusters.size(); ++h)
+            {
+                const uint32_t start = hardClusters[h], end = hardClusters[h + 1];
+
+                cache.flush();
+                size_t clusterMisses = 0;
+                for (uint32_t t = start; t < end; ++t)
+                    clusterMisses += cache.accessTriangle(&indices[t * 3]);
+                const float clusterLimit = threshold * float(clusterMisses) / float(end - start);
+
+                cache.flush();
+                clusters.push_back(start);
+                size_t runningMisses = 0, runningTriangles = 0;
+                for (uint32_t t = start; t < end; ++t)
+                {
+                    runningMisses += cache.accessTriangle(&indices[t * 3]);
+                    ++runningTriangles;
+                    if (t + 1 < end && float(runningMisses) / float(runningTriangles) <= clusterLimit)
+                    {
+                        clusters.push_back(t + 1);
+                        runningMisses = runningTriangles = 0;
+                        cache.flush();
+                    }
+                }
+            }
+            clusters.push_back(static_cast<uint32_t>(triangleCount));
+            const size_t clusterCount = clusters.size() - 1;
+
+            // Area weighted centroid and normal per cluster, plus the mesh centroid
+            std::vector<float> clusterData(clusterCount * 7, 0.0f); // centroid xyz, normal xyz, area
+            float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+            float meshArea = 0.0f;
+            for (size_t c = 0; c < clusterCount; ++c)
+            {
+                float* data = &clusterData[c * 7];
+                for (uint32_t t = clusters[c]; t < clusters[c + 1]; ++t)
+                {
+                    const float* a = mesh.vertices[indices[t * 3 + 0]].Position;
+                    const float* b = mesh.vertices[indices[t * 3 + 1]].Position;
+                    const float* p = mesh.vertices[indices[t * 3 + 2]].Position;
+                    float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                    float e2[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+                    float n[3] = {
+                        e1[1] * e2[2] - e1[2] * e2[1],
+                        e1[2] * e2[0] - e1[0] * e2[2],
+                        e1[0] * e2[1] - e1[1] * e2[0]
+                    };
+                    float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        data[k] += (a[k] + b[k] + p[k]) * (area / 3.0f);
+                        data[3 + k] += n[k];
+                    }
+                    data[6] += area;
+                }
+
+                for (int k = 0; k < 3; ++k)
+                    meshCentroid[k] += data[k];
+                meshArea += data[6];
+                if (data[6] > 0.0f)
+                    for (int k = 0; k < 3; ++k)
+                        data[k] /= data[6];
+            }
+            if (meshArea > 0.0f)
+                for (int k = 0; k < 3; ++k)
+                    meshCentroid[k] /= meshArea;
+
+            std::vector<float> sortKeys(clusterCount);
+            for (size_t c = 0; c < clusterCount; ++c)
+            {
+                const float* data = &clusterData[c * 7];
+                float length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+                float key = 0.0f;
+                if (length > 0.0f)
+                {
+                    for (int k = 0; k < 3; ++k)
+                        key += (data[k] - meshCentroid[k]) * data[3 + k];
+                    key /= length;
+                }
+                sortKeys[c] = key;
+            }
+
+            // Clusters facing away from the centre (the most likely occluders) first
+            std::vector<uint32_t> order(clusterCount);
+            for (size_t c = 0; c < clusterCount; ++c)
+                order[c] = static_cast<uint32_t>(c);
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+            std::vector<unsigned int> reordered;
+            reordered.reserve(indices.size());
+            for (uint32_t c : order)
+                reordered.insert(reordered.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+            reordered.insert(reordered.end(), indices.begin() + triangleCount * 3, indices.end());
+            std::copy(reordered.begin(), reordered.end(), indices.begin());
+        }
+
+        void OptimizeVertexFetch(Mesh& mesh)
+        {
+            std::vector<uint32_t> remap(mesh.vertices.size(), kInvalid);
+            uint32_t nextVertex = 0;
+
+            auto remapIndices = [&](Core::Span<unsigned int> indices) {
+                for (unsigned int& index : indices)
+                {
+                    if (remap[index] == kInvalid)
+                        remap[index] = nextVertex++;
+                    index = remap[index];
+                }
+            };
+            remapIndices(mesh.indices);
+            for (MeshLOD& lod : mesh.lods)
+                remapIndices(lod.indices);
+
+            std::vector<Vertex> vertices(nextVertex);
+            for (size_t v = 0; v < mesh.vertices.size(); ++v)
+            {
+                if (remap[v] != kInvalid)
+                    vertices[remap[v]] = mesh.vertices[v];
+            }
+            std::copy(vertices.begin(), vertices.end(), mesh.vertices.begin());
+            mesh.vertices = mesh.vertices.first(nextVertex);
+        }
+
+        void OptimizeMesh(Mesh& mesh, const MeshOptimizeConfig& config)
+        {
+            OptimizeVertexCache(mesh.indices, mesh.vertices.size(), config.cacheSize);
+            if (config.optimizeOverdraw)
+                OptimizeOverdraw(mesh, mesh.indices, config.overdrawThreshold, config.cacheSize);
+            for (MeshLOD& lod : mesh.lods)
+                OptimizeVertexCache(lod.indices, mesh.vertices.size(), config.cacheSize);
+            if (config.optimizeVertexFetch)
+                OptimizeVertexFetch(mesh);
+        }
+
+        VertexCacheStats AnalyzeVertexCache(Core::Span<const unsigned int> indices, size_t vertexCount, unsigned int cacheSize)
+        {
+            VertexCacheStats stats;
+            const size_t triangleCount = indices.size() / 3;
+            if (triangleCount == 0)
+                return stats;
+
+            vertexCount = std::max(vertexCount, MaxIndex(indices));
+            CacheSimulator cache(vertexCount, cacheSize);
+            std::vector<bool> referenced(vertexCount, false);
+            size_t uniqueVertices = 0;
+            for (size_t i = 0; i < triangleCount * 3; ++i)
+            {
+                unsigned int v = indices[i];
+                stats.misses += !cache.access(v);
+                if (!referenced[v])
+                {
+                    referenced[v] = true;
+                    ++uniqueVertices;
+                }
+            }
+
+            stats.acmr = float(stats.misses) / float(triangleCount);
+            stats.atvr = float(stats.misses) / float(uniqueVertices);
+            return stats;
+        }
+
+        OverdrawStats AnalyzeOverdraw(const Mesh& mesh, Core::Span<const unsigned int> indices)
+        {
+            OverdrawStats stats;
+            const size_t triangleCount = indices.size() / 3;
+            if (triangleCount == 0)
+                return stats;
+
+            float minP[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float maxP[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            for (size_t i = 0; i < triangleCount * 3; ++i)
+            {
+                const float* p = mesh.vertices[indices[i]].Position;
+                for (int k = 0; k < 3; ++k)
+                {
+                    minP[k] = std::min(minP[k], p[k]);
+                    maxP[k] = std::max(maxP[k], p[k]);
+                }
+            }
+            float extent = std::max({ maxP[0] - minP[0], maxP[1] - minP[1], maxP[2] - minP[2] });
+            if (extent <= 0.0f)
+                return stats;
+            const float scale = float(kOverdrawGrid) / extent;
+
+            std::vector<float> depth(kOverdrawGrid * kOverdrawGrid);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const int u = (axis + 1) % 3, w = (axis + 2) % 3;
+                for (int direction = 0; direction < 2; ++direction)
+                {
+                    std::fill(depth.begin(), depth.end(), FLT_MAX);
+                    const float zSign = direction == 0 ? 1.0f : -1.0f;
+
+                    auto project = [&](unsigned int index) {
+                        const float* p = mesh.vertices[index].Position;
+                        return ScreenVertex{ (p[u] - minP[u]) * scale, (p[w] - minP[w]) * scale, (p[axis] - minP[axis]) * zSign };
+                    };
+                    for (size_t t = 0; t < triangleCount; ++t)
+                    {
+                        RasterizeTriangle(project(indices[t * 3 + 0]), project(indices[t * 3 + 1]),
+                                          project(indices[t * 3 + 2]), depth, stats.pixelsShaded);
+                    }
+
+                    for (float z : depth)
+                        stats.pixelsCovered += z != FLT_MAX;
+                }
+            }
+
+            if (stats.pixelsCovered > 0)
+                stats.overdraw = float(stats.pixelsShaded) / float(stats.pixelsCovered);
+            return stats;
+        }
+
+        VertexFetchStats AnalyzeVertexFetch(Core::Span<const unsigned int> indices, size_t vertexCount, size_t vertexSize)
+        {
+            constexpr size_t kLineSize = 64;
+            constexpr size_t kLineCount = 256; // 16 KB, about the size of a GPU L1
+
+            VertexFetchStats stats;
+            if (indices.empty() || vertexSize == 0)
+                return stats;
+
+            vertexCount = std::max(vertexCount, MaxIndex(indices));
+            std::vector<bool> referenced(vertexCount, false);
+            size_t uniqueVertices = 0;
+
+            std::vector<size_t> lines(kLineCount, SIZE_MAX);
+            for (unsigned int index : indices)
+            {
+                if (!referenced[index])
+                {
+                    referenced[index] = true;
+                    ++uniqueVertices;
+                }
+
+                size_t first = index * vertexSize / kLineSize;
+                size_t last = (index * vertexSize + vertexSize - 1) / kLineSize;
+                for (size_t line = first; line <= last; ++line)
+                {
+                    size_t& slot = lines[line % kLineCount];
+                    if (slot != line)
+                    {
+                        slot = line;
+                        stats.bytesFetched += kLineSize;
+                    }
+                }
+            }
+
+            stats.efficiency = float(uniqueVertices * vertexSize) / float(stats.bytesFetched);
+            return stats;
+        }
+
+        MeshMetrics AnalyzeMesh(const Mesh& mesh, unsigned int cacheSize)
+        {
+            MeshMetrics metrics;
+            metrics.vertexCache = AnalyzeVertexCache(mesh.indices, mesh.vertices.size(), cacheSize);
+            metrics.overdraw = AnalyzeOverdraw(mesh, mesh.indices);
+            metrics.vertexFetch = AnalyzeVertexFetch(mesh.indices, mesh.vertices.size(), sizeof(Vertex));
+            return metrics;
+        }
+    }
+}
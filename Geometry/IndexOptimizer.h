@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../ModelLoaders/ModelLoader.h"
+#include "../Core/Span.h"
+#include <cstddef>
+#include <vector>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        // Reorders triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007).
+        // cacheSize is the number of FIFO entries being optimized for.
+        NYX_API void OptimizeVertexCache(Core::Span<unsigned int> indices, size_t vertexCount, unsigned int cacheSize = 16);
+
+        // Reorders clusters of a cache-optimized index list so outward facing clusters are drawn first.
+        // threshold bounds the ACMR increase accepted for smaller clusters (1.05 = up to 5% worse).
+        NYX_API void OptimizeOverdraw(const Mesh& mesh, Core::Span<unsigned int> indices,
+                                      float threshold = 1.05f, unsigned int cacheSize = 16);
+
+        // Renumbers mesh.vertices in first-use order of mesh.indices followed by every LOD, so vertex
+        // fetches walk memory linearly. Vertices no index list references are dropped by shrinking
+        // mesh.vertices; the storage behind it keeps its size.
+        NYX_API void OptimizeVertexFetch(Mesh& mesh);
+
+        // Runs the full pipeline: vertex cache and overdraw on mesh.indices, vertex cache on each LOD,
+        // then vertex fetch over all of them.
+        NYX_API void OptimizeMesh(Mesh& mesh, const MeshOptimizeConfig& config = {});
+
+        struct NYX_API VertexCacheStats
+        {
+            size_t misses = 0;
+            float acmr = 0.0f;  // Misses per triangle: 3 is worst, ~0.5 is ideal for large meshes
+            float atvr = 0.0f;  // Misses per referenced vertex: 1 is ideal
+        };
+
+        struct NYX_API OverdrawStats
+        {
+            size_t pixelsCovered = 0;
+            size_t pixelsShaded = 0;
+            float overdraw = 0.0f;  // Shaded / covered: 1 is ideal
+        };
+
+        struct NYX_API VertexFetchStats
+        {
+            size_t bytesFetched = 0;
+            float efficiency = 0.0f; // Referenced vertex bytes / fetched bytes: 1 is ideal
+        };
+
+        struct NYX_API MeshMetrics
+        {
+            VertexCacheStats vertexCache;
+            OverdrawStats overdraw;
+            VertexFetchStats vertexFetch;
+        };
+
+        // Simulates a FIFO post-transform cache of cacheSize entries.
+        NYX_API VertexCacheStats AnalyzeVertexCache(Core::Span<const unsigned int> indices, size_t vertexCount,
+                                                    unsigned int cacheSize = 16);
+
+        // Rasterizes the mesh in software from the six axis directions with depth testing and
+        // counts how many pixels pass the depth test versus how many end up covered.
+        NYX_API OverdrawStats AnalyzeOverdraw(const Mesh& mesh, Core::Span<const unsigned int> indices);
+
+        // Simulates a small direct-mapped cache of 64 byte lines in front of the vertex buffer.
+        // vertexSize is the GPU stride, e.g. sizeof(Vertex) or EncodedVertices::stride.
+        NYX_API VertexFetchStats AnalyzeVertexFetch(Core::Span<const unsigned int> indices, size_t vertexCount,
+                                                    size_t vertexSize);
+
+        // All three metrics for mesh.indices with sizeof(Vertex) as the vertex stride.
+        NYX_API MeshMetrics AnalyzeMesh(const Mesh& mesh, unsigned int cacheSize = 16);
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include <cstdint>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        // A contiguous run of indices inside a mesh's index buffer.
+        struct NYX_API IndexRange
+        {
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+        };
+    }
+}
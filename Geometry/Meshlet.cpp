@@ -0,0 +1,303 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        namespace
+        {
+            struct TriangleAdjacency
+            {
+                std::vector<uint32_t> offsets;   // Per vertex, into triangles
+                std::vector<uint32_t> triangles;
+            };
+
+            TriangleAdjacency BuildAdjacency(Core::Span<const unsigned int> indices, size_t vertexCount)
+            {
+                TriangleAdjacency adjacency;
+                adjacency.offsets.assign(vertexCount + 1, 0);
+                for (unsigned int index : indices)
+                    ++adjacency.offsets[index + 1];
+                for (size_t i = 0; i < vertexCount; ++i)
+                    adjacency.offsets[i + 1] += adjacency.offsets[i];
+
+                adjacency.triangles.resize(indices.size());
+                std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+                for (size_t i = 0; i < indices.size(); ++i)
+                    adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+                return adjacency;
+            }
+
+            void ComputeMeshletBounds(const Mesh& mesh, Meshlet& meshlet, std::vector<float>& scratch)
+            {
+                const unsigned int* indices = mesh.indices.data() + meshlet.firstIndex;
+                const size_t triangleCount = meshlet.indexCount / 3;
+
+                scratch.clear();
+                for (size_t i = 0; i < meshlet.indexCount; ++i)
+                {
+                    const float* p = mesh.vertices[indices[i]].Position;
+                    scratch.insert(scratch.end(), p, p + 3);
+                }
+                meshlet.bounds = ComputeBoundingSphere(scratch.data(), meshlet.indexCount, sizeof(float) * 3);
+
+                // Normal cone from the (unweighted) face normals
+                std::vector<float>& normals = scratch;
+                normals.clear();
+                float axis[3] = { 0.0f, 0.0f, 0.0f };
+                for (size_t t = 0; t < triangleCount; ++t)
+                {
+                    const float* a = mesh.vertices[indices[t * 3 + 0]].Position;
+                    const float* b = mesh.vertices[indices[t * 3 + 1]].Position;
+                    const float* c = mesh.vertices[indices[t * 3 + 2]].Position;
+                    float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                    float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+                    float n[3] = {
+                        e1[1] * e2[2] - e1[2] * e2[1],
+                        e1[2] * e2[0] - e1[0] * e2[2],
+                        e1[0] * e2[1] - e1[1] * e2[0]
+                    };
+                    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    if (length <= 0.0f)
+                        continue; // Degenerate triangles never face the camera
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        n[k] /= length;
+                        axis[k] += n[k];
+                    }
+                    normals.insert(normals.end(), n, n + 3);
+                }
+
+                float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+                meshlet.coneCutoff = 1.0f;
+                if (axisLength <= 0.0f || normals.empty())
+                    return;
+
+                for (int k = 0; k < 3; ++k)
+                    meshlet.coneAxis[k] = axis[k] / axisLength;
+
+                float minDot = 1.0f;
+                for (size_t i = 0; i < normals.size(); i += 3)
+                {
+                    float d = normals[i] * meshlet.coneAxis[0] + normals[i + 1] * meshlet.coneAxis[1] +
+                              normals[i + 2] * meshlet.coneAxis[2];
+                    minDot = std::min(minDot, d);
+                }
+
+                // Normals spread over more than a hemisphere: the cluster can always be seen from somewhere
+                if (minDot <= 0.1f)
+                    return;
+                meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+        }
+
+        std::vector<Meshlet> BuildMeshlets(Mesh& mesh, const MeshletConfig& config)
+        {
+            std::vector<Meshlet> meshlets;
+            const size_t triangleCount = mesh.indices.size() / 3;
+            if (triangleCount == 0 || config.maxVertices < 3 || config.maxTriangles == 0)
+                return meshlets;
+
+            Core::Span<const unsigned int> indices = mesh.indices;
+            TriangleAdjacency adjacency = BuildAdjacency(indices, mesh.vertices.size());
+
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> vertexTag(mesh.vertices.size(), UINT32_MAX);  // Meshlet that last used the vertex
+            std::vector<uint32_t> candidateTag(triangleCount, UINT32_MAX);      // Meshlet that queued the triangle
+            std::vector<uint32_t> liveTriangles(mesh.vertices.size(), 0);
+            for (unsigned int index : indices)
+                ++liveTriangles[index];
+
+            std::vector<unsigned int> reordered;
+            reordered.reserve(indices.size());
+            std::vector<uint32_t> meshletVertices;
+            meshletVertices.reserve(config.maxVertices);
+            std::vector<uint32_t> candidates;
+
+            size_t seedCursor = 0;
+            while (true)
+            {
+                while (seedCursor < triangleCount && emitted[seedCursor])
+                    ++seedCursor;
+                if (seedCursor == triangleCount)
+                    break;
+
+                const uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+                Meshlet meshlet;
+                meshlet.firstIndex = static_cast<uint32_t>(reordered.size());
+                meshletVertices.clear();
+                candidates.clear();
+                uint32_t meshletTriangles = 0;
+
+                auto emit = [&](uint32_t triangle) {
+                    emitted[triangle] = true;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        unsigned int v = indices[triangle * 3 + k];
+                        if (vertexTag[v] != meshletId)
+                        {
+                            vertexTag[v] = meshletId;
+                            meshletVertices.push_back(v);
+
+                            // Triangles touching a new meshlet vertex become growth candidates
+                            for (uint32_t a = adjacency.offsets[v]; a < adjacency.offsets[v + 1]; ++a)
+                            {
+                                uint32_t neighbour = adjacency.triangles[a];
+                                if (!emitted[neighbour] && candidateTag[neighbour] != meshletId)
+                                {
+                                    candidateTag[neighbour] = meshletId;
+                                    candidates.push_back(neighbour);
+                                }
+                            }
+                        }
+                        --liveTriangles[v];
+                        reordered.push_back(v);
+                    }
+                    ++meshletTriangles;
+                };
+
+                auto countNewVertices = [&](uint32_t triangle) {
+                    int newVertices = 0;
+                    for (int k = 0; k < 3; ++k)
+                        newVertices += vertexTag[indices[triangle * 3 + k]] != meshletId;
+                    return newVertices;
+                };
+
+                uint32_t lastTriangle = static_cast<uint32_t>(seedCursor);
+                emit(lastTriangle);
+
+                // Grow the meshlet with the candidate that adds the fewest new vertices,
+                // preferring triangles whose vertices have few remaining neighbours (the mesh boundary).
+                while (meshletTriangles < config.maxTriangles)
+                {
+                    // Fast path: a neighbour of the last triangle that closes a gap for free
+                    uint32_t freeTriangle = UINT32_MAX;
+                    for (int k = 0; k < 3 && freeTriangle == UINT32_MAX; ++k)
+                    {
+                        unsigned int v = indices[lastTriangle * 3 + k];
+                        for (uint32_t a = adjacency.offsets[v]; a < adjacency.offsets[v + 1]; ++a)
+                        {
+                            uint32_t neighbour = adjacency.triangles[a];
+                            if (!emitted[neighbour] && countNewVertices(neighbour) == 0)
+                            {
+                                freeTriangle = neighbour;
+                                break;
+                            }
+                        }
+                    }
+                    if (freeTriangle != UINT32_MAX)
+                    {
+                        lastTriangle = freeTriangle;
+                        emit(freeTriangle);
+                        continue;
+                    }
+
+                    size_t bestSlot = SIZE_MAX;
+                    int bestNewVertices = 4;
+                    uint32_t bestLive = UINT32_MAX;
+
+                    for (size_t slot = 0; slot < candidates.size();)
+                    {
+                        uint32_t triangle = candidates[slot];
+                        if (emitted[triangle])
+                        {
+                            candidates[slot] = candidates.back();
+                            candidates.pop_back();
+                            continue;
+                        }
+
+                        int newVertices = 0;
+                        uint32_t live = 0;
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            unsigned int tv = indices[triangle * 3 + k];
+                            newVertices += vertexTag[tv] != meshletId;
+                            live += liveTriangles[tv];
+                        }
+
+                        if (meshletVertices.size() + newVertices <= config.maxVertices &&
+                            (newVertices < bestNewVertices || (newVertices == bestNewVertices && live < bestLive)))
+                        {
+                            bestSlot = slot;
+                            bestNewVertices = newVertices;
+                            bestLive = live;
+                        }
+                        ++slot;
+                    }
+
+                    if (bestSlot == SIZE_MAX)
+                        break;
+                    lastTriangle = candidates[bestSlot];
+                    candidates[bestSlot] = candidates.back();
+                    candidates.pop_back();
+                    emit(lastTriangle);
+                }
+
+                meshlet.indexCount = meshletTriangles * 3;
+                meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+                meshlets.push_back(meshlet);
+            }
+
+            // Keep any trailing non-triangle indices so the index count never changes
+            reordered.insert(reordered.end(), indices.begin() + triangleCount * 3, indices.end());
+            std::copy(reordered.begin(), reordered.end(), mesh.indices.begin());
+
+            std::vector<float> scratch;
+            for (Meshlet& meshlet : meshlets)
+                ComputeMeshletBounds(mesh, meshlet, scratch);
+
+            return meshlets;
+        }
+
+        void CullMeshlets(const std::vector<Meshlet>& meshlets, const Frustum& frustum,
+                          const float cameraPosition[3], std::vector<IndexRange>& outRanges,
+                          ClusterCullStats* stats)
+        {
+            outRanges.clear();
+            ClusterCullStats local;
+
+            for (const Meshlet& meshlet : meshlets)
+            {
+                local.totalTriangles += meshlet.indexCount / 3;
+
+                if (!frustum.intersects(meshlet.bounds))
+                {
+                    ++local.frustumCulled;
+                    continue;
+                }
+
+                if (meshlet.coneCutoff < 1.0f)
+                {
+                    float d[3] = {
+                        meshlet.bounds.center[0] - cameraPosition[0],
+                        meshlet.bounds.center[1] - cameraPosition[1],
+                        meshlet.bounds.center[2] - cameraPosition[2]
+                    };
+                    float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                    float along = d[0] * meshlet.coneAxis[0] + d[1] * meshlet.coneAxis[1] + d[2] * meshlet.coneAxis[2];
+                    if (along >= meshlet.coneCutoff * distance + meshlet.bounds.radius)
+                    {
+                        ++local.backfaceCulled;
+                        continue;
+                    }
+                }
+
+                local.submittedTriangles += meshlet.indexCount / 3;
+                if (!outRanges.empty() &&
+                    outRanges.back().firstIndex + outRanges.back().indexCount == meshlet.firstIndex)
+                {
+                    outRanges.back().indexCount += meshlet.indexCount;
+                }
+                else
+                {
+                    outRanges.push_back({ meshlet.firstIndex, meshlet.indexCount });
+                }
+            }
+
+            if (stats)
+                *stats = local;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../ModelLoaders/ModelLoader.h"
+#include "Bounds.h"
+#include "IndexRange.h"
+#include <cstdint>
+#include <vector>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        // A small cluster of triangles. After BuildMeshlets its triangles occupy
+        // [firstIndex, firstIndex + indexCount) of Mesh::indices.
+        struct NYX_API Meshlet
+        {
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+            uint32_t vertexCount = 0;
+            BoundingSphere bounds;
+            // Normal cone. The cluster is back-facing for every camera position where
+            // dot(center - camera, axis) >= cutoff * |center - camera| + radius. cutoff == 1 disables the test.
+            float coneAxis[3] = { 0.0f, 0.0f, 0.0f };
+            float coneCutoff = 1.0f;
+        };
+
+        struct NYX_API MeshletConfig
+        {
+            uint32_t maxVertices = 64;
+            uint32_t maxTriangles = 124;
+        };
+
+        struct NYX_API ClusterCullStats
+        {
+            size_t totalTriangles = 0;
+            size_t submittedTriangles = 0;
+            size_t frustumCulled = 0;   // Clusters
+            size_t backfaceCulled = 0;  // Clusters
+        };
+
+        // Splits the mesh into meshlets, reordering mesh.indices in place so each meshlet is contiguous.
+        // The vertex buffer is untouched, so existing VBOs stay valid but the IBO must be re-uploaded.
+        NYX_API std::vector<Meshlet> BuildMeshlets(Mesh& mesh, const MeshletConfig& config = {});
+
+        // Rejects clusters that are outside the frustum or entirely back-facing and writes the surviving
+        // index ranges to outRanges, merging neighbours so the result is ready for a multi-draw.
+        // The frustum and camera position must be in the mesh's local space.
+        NYX_API void CullMeshlets(const std::vector<Meshlet>& meshlets, const Frustum& frustum,
+                                  const float cameraPosition[3], std::vector<IndexRange>& outRanges,
+                                  ClusterCullStats* stats = nullptr);
+    }
+}
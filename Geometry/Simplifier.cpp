@@ -0,0 +1,405 @@
+#include "Simplifier.h"
+#include "Bounds.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        namespace
+        {
+            // Symmetric 4x4 plane quadric plus the accumulated area weight
+            struct Quadric
+            {
+                double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+                double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+                double weight = 0;
+
+                static Quadric FromPlane(double a, double b, double c, double d, double w)
+                {
+                    Quadric q;
+                    q.a2 = a * a * w; q.b2 = b * b * w; q.c2 = c * c * w; q.d2 = d * d * w;
+                    q.ab = a * b * w; q.ac = a * c * w; q.ad = a * d * w;
+                    q.bc = b * c * w; q.bd = b * d * w; q.cd = c * d * w;
+                    q.weight = w;
+                    return q;
+                }
+
+                void add(const Quadric& o)
+                {
+                    a2 += o.a2; b2 += o.b2; c2 += o.c2; d2 += o.d2;
+                    ab += o.ab; ac += o.ac; ad += o.ad; bc += o.bc; bd += o.bd; cd += o.cd;
+                    weight += o.weight;
+                }
+
+                double evaluate(const float* p) const
+                {
+                    double x = p[0], y = p[1], z = p[2];
+                    double r = a2 * x * x + b2 * y * y + c2 * z * z + d2
+                        + 2.0 * (ab * x * y + ac * x * z + bc * y * z)
+                        + 2.0 * (ad * x + bd * y + cd * z);
+                    return r > 0.0 ? r : 0.0;
+                }
+            };
+
+            enum class VertexKind : uint8_t { Manifold, Border, Locked };
+
+            struct Collapse
+            {
+                unsigned int source;    // Actual vertex that disappears (never a seam vertex)
+                unsigned int target;    // Actual vertex it merges into
+                double cost;
+                double error;           // Geometric part of cost, squared distance
+            };
+
+            inline uint64_t EdgeKey(unsigned int a, unsigned int b)
+            {
+                return (static_cast<uint64_t>(a) << 32) | b;
+            }
+
+            void TriangleNormal(const float* a, const float* b, const float* c, float* n)
+            {
+                float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+                n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+                n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+                n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+            }
+
+            float AttributeDistanceSq(const Vertex& a, const Vertex& b)
+            {
+                float d = 0.0f;
+                for (int k = 0; k < 3; ++k)
+                    d += (a.Normal[k] - b.Normal[k]) * (a.Normal[k] - b.Normal[k]);
+                for (int k = 0; k < 2; ++k)
+                    d += (a.TexCoords[k] - b.TexCoords[k]) * (a.TexCoords[k] - b.TexCoords[k]);
+                return d;
+            }
+        }
+
+        std::vector<unsigned int> Simplify(const Mesh& mesh, Core::Span<const unsigned int> inIndices,
+                                           size_t targetIndexCount, float targetError,
+                                           const SimplifyOptions& options, float* outError)
+        {
+            std::vector<unsigned int> indices(inIndices.begin(), inIndices.begin() + (inIndices.size() / 3) * 3);
+            const size_t vertexCount = mesh.vertices.size();
+            double maxError = 0.0;
+
+            if (indices.size() <= targetIndexCount || vertexCount == 0)
+            {
+                if (outError) *outError = 0.0f;
+                return indices;
+            }
+
+            // Wedges: vertices sharing a position collapse as one topological vertex
+            std::vector<unsigned int> wedge(vertexCount);
+            std::vector<uint32_t> wedgeSize(vertexCount, 0);
+            {
+                struct PositionHash
+                {
+                    size_t operator()(const std::array<uint32_t, 3>& p) const
+                    {
+                        return (p[0] * 73856093u) ^ (p[1] * 19349663u) ^ (p[2] * 83492791u);
+                    }
+                };
+                std::unordered_map<std::array<uint32_t, 3>, unsigned int, PositionHash> firstAt;
+                firstAt.reserve(vertexCount);
+                for (unsigned int v = 0; v < vertexCount; ++v)
+                {
+                    std::array<uint32_t, 3> key;
+                    std::memcpy(key.data(), mesh.vertices[v].Position, sizeof(float) * 3);
+                    auto it = firstAt.emplace(key, v).first;
+                    wedge[v] = it->second;
+                    ++wedgeSize[it->second];
+                }
+            }
+
+            // Classify: seams are locked, borders are locked or restricted to sliding along the border
+            std::vector<VertexKind> kind(vertexCount, VertexKind::Manifold);
+            {
+                std::unordered_set<uint64_t> directed;
+                directed.reserve(indices.size());
+                for (size_t i = 0; i < indices.size(); i += 3)
+                    for (int e = 0; e < 3; ++e)
+                        directed.insert(EdgeKey(wedge[indices[i + e]], wedge[indices[i + (e + 1) % 3]]));
+
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        unsigned int a = wedge[indices[i + e]], b = wedge[indices[i + (e + 1) % 3]];
+                        if (!directed.count(EdgeKey(b, a)))
+                        {
+                            kind[a] = std::max(kind[a], VertexKind::Border);
+                            kind[b] = std::max(kind[b], VertexKind::Border);
+                        }
+                    }
+                }
+                for (unsigned int v = 0; v < vertexCount; ++v)
+                {
+                    if (wedgeSize[wedge[v]] > 1)
+                        kind[wedge[v]] = VertexKind::Locked;
+                    if (options.lockBorder && kind[wedge[v]] == VertexKind::Border)
+                        kind[wedge[v]] = VertexKind::Locked;
+                }
+            }
+
+            // Area weighted plane quadrics per wedge, plus border-preserving planes for sliding borders
+            std::vector<Quadric> quadrics(vertexCount);
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const float* p[3] = {
+                    mesh.vertices[indices[i]].Position,
+                    mesh.vertices[indices[i + 1]].Position,
+                    mesh.vertices[indices[i + 2]].Position
+                };
+                float n[3];
+                TriangleNormal(p[0], p[1], p[2], n);
+                double length = std::sqrt(double(n[0]) * n[0] + double(n[1]) * n[1] + double(n[2]) * n[2]);
+                if (length <= 0.0)
+                    continue;
+                double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+                double d = -(a * p[0][0] + b * p[0][1] + c * p[0][2]);
+                Quadric q = Quadric::FromPlane(a, b, c, d, length * 0.5);
+                for (int k = 0; k < 3; ++k)
+                    quadrics[wedge[indices[i + k]]].add(q);
+
+                if (!options.lockBorder)
+                {
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        unsigned int wa = wedge[indices[i + e]], wb = wedge[indices[i + (e + 1) % 3]];
+                        if (kind[wa] != VertexKind::Border || kind[wb] != VertexKind::Border)
+                            continue;
+                        const float* pa = p[e];
+                        const float* pb = p[(e + 1) % 3];
+                        double ex = pb[0] - pa[0], ey = pb[1] - pa[1], ez = pb[2] - pa[2];
+                        // Plane through the edge, perpendicular to the triangle
+                        double px = ey * c - ez * b, py = ez * a - ex * c, pz = ex * b - ey * a;
+                        double pl = std::sqrt(px * px + py * py + pz * pz);
+                        if (pl <= 0.0)
+                            continue;
+                        px /= pl; py /= pl; pz /= pl;
+                        double pd = -(px * pa[0] + py * pa[1] + pz * pa[2]);
+                        Quadric bq = Quadric::FromPlane(px, py, pz, pd, pl * pl);
+                        bq.weight = 0.0;
+                        quadrics[wa].add(bq);
+                        quadrics[wb].add(bq);
+                    }
+                }
+            }
+
+            const BoundingSphere bounds = ComputeBoundingSphere(mesh.vertices[0].Position, vertexCount, sizeof(Vertex));
+            const double attributeScale = double(options.attributeWeight) * bounds.radius;
+            const double errorLimit = double(targetError) * targetError;
+
+            std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+            std::vector<uint32_t> vertexTriangles;
+            std::vector<uint8_t> touched(vertexCount);
+            std::vector<unsigned int> collapseTo(vertexCount);
+            std::vector<Collapse> candidates;
+            std::unordered_set<uint64_t> directed;
+
+            while (indices.size() > targetIndexCount)
+            {
+                const size_t triangleCount = indices.size() / 3;
+
+                // Triangles around each wedge
+                std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+                for (unsigned int index : indices)
+                    ++triangleOffsets[wedge[index] + 1];
+                for (size_t v = 0; v < vertexCount; ++v)
+                    triangleOffsets[v + 1] += triangleOffsets[v];
+                vertexTriangles.resize(indices.size());
+                {
+                    std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+                    for (size_t i = 0; i < indices.size(); ++i)
+                        vertexTriangles[fill[wedge[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+                }
+
+                directed.clear();
+                if (!options.lockBorder)
+                {
+                    for (size_t i = 0; i < indices.size(); i += 3)
+                        for (int e = 0; e < 3; ++e)
+                            directed.insert(EdgeKey(wedge[indices[i + e]], wedge[indices[i + (e + 1) % 3]]));
+                }
+
+                // Score every collapse of a movable vertex onto one of its neighbours
+                candidates.clear();
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        for (int dir = 0; dir < 2; ++dir)
+                        {
+                            unsigned int source = indices[i + (dir ? (e + 1) % 3 : e)];
+                            unsigned int target = indices[i + (dir ? e : (e + 1) % 3)];
+                            unsigned int ws = wedge[source], wt = wedge[target];
+                            if (ws == wt || kind[ws] == VertexKind::Locked)
+                                continue;
+                            if (kind[ws] == VertexKind::Border)
+                            {
+                                // Only slide along a border edge onto another border vertex
+                                bool borderEdge = !directed.count(EdgeKey(ws, wt)) || !directed.count(EdgeKey(wt, ws));
+                                if (kind[wt] == VertexKind::Manifold || !borderEdge)
+                                    continue;
+                            }
+
+                            Quadric q = quadrics[ws];
+                            q.add(quadrics[wt]);
+                            double error = q.weight > 0.0 ? q.evaluate(mesh.vertices[target].Position) / q.weight
+                                                          : q.evaluate(mesh.vertices[target].Position);
+                            double attribute = attributeScale * attributeScale *
+                                AttributeDistanceSq(mesh.vertices[source], mesh.vertices[target]);
+                            candidates.push_back({ source, target, error + attribute, error });
+                        }
+                    }
+                }
+                if (candidates.empty())
+                    break;
+
+                std::sort(candidates.begin(), candidates.end(),
+                    [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+                std::fill(touched.begin(), touched.end(), 0);
+                for (unsigned int v = 0; v < vertexCount; ++v)
+                    collapseTo[v] = v;
+
+                size_t removedTriangles = 0;
+                const size_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+                size_t applied = 0;
+
+                for (const Collapse& c : candidates)
+                {
+                    if (removedTriangles >= trianglesToRemove || c.cost > errorLimit)
+                        break;
+
+                    unsigned int ws = wedge[c.source], wt = wedge[c.target];
+                    if (touched[ws] || touched[wt])
+                        continue;
+
+                    // Reject collapses that flip or squash a surviving triangle
+                    bool valid = true;
+                    size_t collapsed = 0;
+                    const float* targetPos = mesh.vertices[c.target].Position;
+                    for (uint32_t a = triangleOffsets[ws]; a < triangleOffsets[ws + 1] && valid; ++a)
+                    {
+                        size_t t = vertexTriangles[a] * size_t(3);
+                        unsigned int w0 = wedge[indices[t]], w1 = wedge[indices[t + 1]], w2 = wedge[indices[t + 2]];
+                        if (w0 == wt || w1 == wt || w2 == wt)
+                        {
+                            ++collapsed;
+                            continue;
+                        }
+
+                        const float* p[3] = {
+                            mesh.vertices[indices[t]].Position,
+                            mesh.vertices[indices[t + 1]].Position,
+                            mesh.vertices[indices[t + 2]].Position
+                        };
+                        float before[3], after[3];
+                        TriangleNormal(p[0], p[1], p[2], before);
+                        p[w0 == ws ? 0 : (w1 == ws ? 1 : 2)] = targetPos;
+                        TriangleNormal(p[0], p[1], p[2], after);
+
+                        float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                        float lb = std::sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2]);
+                        float la = std::sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+                        if (dot <= 0.25f * lb * la)
+                            valid = false;
+                    }
+                    if (!valid)
+                        continue;
+
+                    collapseTo[c.source] = c.target;
+                    touched[ws] = touched[wt] = 1;
+                    quadrics[wt].add(quadrics[ws]);
+                    maxError = std::max(maxError, c.error);
+                    removedTriangles += collapsed;
+                    ++applied;
+                }
+
+                if (applied == 0)
+                    break;
+
+                // Apply the collapses and drop triangles that became degenerate
+                size_t write = 0;
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    unsigned int a = collapseTo[indices[i]], b = collapseTo[indices[i + 1]], c = collapseTo[indices[i + 2]];
+                    if (wedge[a] == wedge[b] || wedge[b] == wedge[c] || wedge[a] == wedge[c])
+                        continue;
+                    indices[write++] = a;
+                    indices[write++] = b;
+                    indices[write++] = c;
+                }
+                indices.resize(write);
+            }
+
+            if (outError)
+                *outError = static_cast<float>(std::sqrt(maxError));
+            return indices;
+        }
+
+        std::vector<MeshLOD> GenerateLODChain(const Mesh& mesh, const LODConfig& config)
+        {
+            std::vector<MeshLOD> lods;
+            if (mesh.vertices.empty() || mesh.indices.size() < 3)
+                return lods;
+
+            const BoundingSphere bounds = ComputeBoundingSphere(mesh.vertices[0].Position, mesh.vertices.size(), sizeof(Vertex));
+            const float errorLimit = config.maxError * bounds.radius;
+
+            SimplifyOptions options;
+            options.attributeWeight = config.attributeWeight;
+            options.lockBorder = config.lockBorder;
+
+            Core::Span<const unsigned int> source = mesh.indices;
+            float accumulatedError = 0.0f;
+
+            for (unsigned int level = 0; level < config.levelCount; ++level)
+            {
+                size_t target = static_cast<size_t>(source.size() * config.reductionPerLevel) / 3 * 3;
+                float error = 0.0f;
+                MeshLOD lod;
+                lod.indices = Simplify(mesh, source, target, errorLimit, options, &error);
+
+                // Not worth a level if it barely reduced anything
+                if (lod.indices.empty() || lod.indices.size() > source.size() * 0.95f)
+                    break;
+
+                accumulatedError += error;
+                lod.error = accumulatedError;
+                lods.push_back(std::move(lod));
+                source = lods.back().indices;
+            }
+            return lods;
+        }
+
+        size_t SelectLOD(const std::vector<MeshLOD>& lods, float distance, const LODSelection& selection)
+        {
+            if (lods.empty())
+                return 0;
+            distance = std::max(distance, 1e-4f);
+
+            // Pixels per mesh unit at this distance
+            float pixelsPerUnit = selection.screenHeight / (2.0f * std::tan(selection.verticalFov * 0.5f) * distance);
+
+            size_t chosen = 0;
+            for (size_t i = 0; i < lods.size(); ++i)
+            {
+                if (lods[i].error * pixelsPerUnit > selection.pixelThreshold)
+                    break;
+                chosen = i + 1;
+            }
+            return chosen;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../ModelLoaders/ModelLoader.h"
+#include "../Core/Span.h"
+#include <cstddef>
+#include <vector>
+
+namespace Nyx
+{
+    namespace Geometry
+    {
+        struct NYX_API SimplifyOptions
+        {
+            float attributeWeight = 0.05f;
+            bool lockBorder = true;
+        };
+
+        /**
+         * Quadric error metric simplification by half-edge collapse.
+         *
+         * Vertices only ever move onto existing vertices, so the result indexes the unchanged
+         * mesh.vertices. Attribute seams (same position, different normal/UV) are always kept,
+         * open borders are kept when options.lockBorder is set and otherwise only slide along
+         * themselves. Stops at targetIndexCount or once the next collapse would exceed targetError
+         * (in mesh units). outError receives the largest error introduced.
+         */
+        NYX_API std::vector<unsigned int> Simplify(const Mesh& mesh, Core::Span<const unsigned int> indices,
+                                                   size_t targetIndexCount, float targetError,
+                                                   const SimplifyOptions& options = {}, float* outError = nullptr);
+
+        // Builds successively coarser levels, each simplified from the previous one.
+        // Stops early once a level can no longer be reduced within the error bound.
+        NYX_API std::vector<MeshLOD> GenerateLODChain(const Mesh& mesh, const LODConfig& config = {});
+
+        struct NYX_API LODSelection
+        {
+            float screenHeight = 1080.0f;           // Viewport height in pixels
+            float verticalFov = 0.785398f;          // Radians
+            float pixelThreshold = 1.0f;            // Largest acceptable error on screen
+        };
+
+        // Picks the coarsest level whose error projects to at most pixelThreshold pixels at the
+        // given view distance. Returns 0 for the full mesh and i + 1 for lods[i].
+        NYX_API size_t SelectLOD(const std::vector<MeshLOD>& lods, float distance, const LODSelection& selection = {});
+    }
+}
@@ -0,0 +1,175 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Nyx
+{
+    namespace IO
+    {
+        MappedFile::MappedFile(const std::string& path, AccessPattern pattern)
+        {
+            open(path, pattern);
+        }
+
+        MappedFile::~MappedFile()
+        {
+            close();
+        }
+
+        MappedFile::MappedFile(MappedFile&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+        {
+            if (this != &other)
+            {
+                close();
+                m_Data = std::exchange(other.m_Data, nullptr);
+                m_Size = std::exchange(other.m_Size, 0);
+                m_Open = std::exchange(other.m_Open, false);
+#ifdef _WIN32
+                m_FileHandle = std::exchange(other.m_FileHandle, nullptr);
+                m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+#endif
+            }
+            return *this;
+        }
+
+        bool MappedFile::open(const std::string& path, AccessPattern pattern)
+        {
+            close();
+#ifdef _WIN32
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size))
+            {
+                CloseHandle(file);
+                return false;
+            }
+            m_FileHandle = file;
+            m_Size = static_cast<size_t>(size.QuadPart);
+            m_Open = true;
+            if (m_Size == 0)
+                return true; // Zero-length files cannot be mapped
+
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping)
+            {
+                close();
+                return false;
+            }
+            m_MappingHandle = mapping;
+
+            m_Data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!m_Data)
+            {
+                close();
+                return false;
+            }
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            m_Size = static_cast<size_t>(st.st_size);
+            m_Open = true;
+            if (m_Size == 0)
+            {
+                ::close(fd);
+                return true; // Zero-length files cannot be mapped
+            }
+
+            void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd); // The mapping keeps its own reference to the file
+            if (data == MAP_FAILED)
+            {
+                m_Size = 0;
+                m_Open = false;
+                return false;
+            }
+            m_Data = data;
+            if (pattern != AccessPattern::Normal)
+                advise(pattern);
+#endif
+            return true;
+        }
+
+        bool MappedFile::advise(AccessPattern pattern, size_t offset, size_t length) const
+        {
+#ifdef _WIN32
+            return m_Data != nullptr;
+#else
+            if (!m_Data || offset >= m_Size)
+                return false;
+
+            const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t begin = offset;
+            size_t end = length < m_Size - offset ? offset + length : m_Size;
+            if (pattern == AccessPattern::DontNeed)
+            {
+                begin = (begin + pageSize - 1) / pageSize * pageSize;
+                if (end != m_Size)
+                    end = end / pageSize * pageSize;
+                if (begin >= end)
+                    return true;
+            }
+            else
+            {
+                begin = begin / pageSize * pageSize;
+            }
+
+            int advice = MADV_NORMAL;
+            switch (pattern)
+            {
+            case AccessPattern::Normal: advice = MADV_NORMAL; break;
+            case AccessPattern::Sequential: advice = MADV_SEQUENTIAL; break;
+            case AccessPattern::Random: advice = MADV_RANDOM; break;
+            case AccessPattern::WillNeed: advice = MADV_WILLNEED; break;
+            case AccessPattern::DontNeed: advice = MADV_DONTNEED; break;
+            }
+            return madvise(static_cast<char*>(m_Data) + begin, end - begin, advice) == 0;
+#endif
+        }
+
+        void MappedFile::close()
+        {
+#ifdef _WIN32
+            if (m_Data)
+                UnmapViewOfFile(m_Data);
+            if (m_MappingHandle)
+                CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+            if (m_FileHandle)
+                CloseHandle(static_cast<HANDLE>(m_FileHandle));
+            m_MappingHandle = nullptr;
+            m_FileHandle = nullptr;
+#else
+            if (m_Data)
+                munmap(m_Data, m_Size);
+#endif
+            m_Data = nullptr;
+            m_Size = 0;
+            m_Open = false;
+        }
+    }
+}
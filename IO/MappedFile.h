@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "../NyxAPI.h"
+
+namespace Nyx
+{
+    namespace IO
+    {
+        // How a mapped range will be read, passed to madvise. No-ops on Windows, where views opened with
+        // FILE_FLAG_SEQUENTIAL_SCAN already read ahead.
+        enum class AccessPattern
+        {
+            Normal,
+            Sequential,  // Read ahead aggressively, pages behind the reader may be dropped early
+            Random,      // No read-ahead
+            WillNeed,    // Start reading the range in now
+            DontNeed     // Drop the range's pages; touching them again faults them back in from the file
+        };
+
+        // Read-only memory mapping of a whole file. The view stays valid until close() or destruction.
+        class NYX_API MappedFile
+        {
+        public:
+            MappedFile() = default;
+            MappedFile(const std::string& path, AccessPattern pattern = AccessPattern::Normal);
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+            MappedFile(MappedFile&& other) noexcept;
+            MappedFile& operator=(MappedFile&& other) noexcept;
+
+            bool open(const std::string& path, AccessPattern pattern = AccessPattern::Normal);
+            void close();
+
+            // Hint for bytes [offset, offset + length) of the view, widened to whole pages (narrowed for
+            // DontNeed so neighbouring data stays resident). Returns false if the kernel rejected it.
+            bool advise(AccessPattern pattern, size_t offset = 0, size_t length = SIZE_MAX) const;
+
+            inline bool isOpen() const { return m_Open; }
+            inline const unsigned char* data() const { return static_cast<const unsigned char*>(m_Data); }
+            inline size_t size() const { return m_Size; }
+
+        private:
+            void* m_Data = nullptr;
+            size_t m_Size = 0;
+            bool m_Open = false;
+#ifdef _WIN32
+            void* m_FileHandle = nullptr;
+            void* m_MappingHandle = nullptr;
+#endif
+        };
+    }
+}
@@ -0,0 +1,412 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Nyx {
+    namespace Image
+    {
+        namespace
+        {
+            // Principal axis of the points by power iteration on their covariance matrix
+            template<int N>
+            void ComputeAxis(const float (*points)[N], int count, float* mean, float* axis)
+            {
+                for (int c = 0; c < N; ++c) mean[c] = 0.0f;
+                for (int i = 0; i < count; ++i)
+                    for (int c = 0; c < N; ++c) mean[c] += points[i][c];
+                for (int c = 0; c < N; ++c) mean[c] /= float(count);
+
+                float covariance[N][N] = {};
+                for (int i = 0; i < count; ++i) {
+                    float d[N];
+                    for (int c = 0; c < N; ++c) d[c] = points[i][c] - mean[c];
+                    for (int r = 0; r < N; ++r)
+                        for (int c = 0; c < N; ++c) covariance[r][c] += d[r] * d[c];
+                }
+
+                for (int c = 0; c < N; ++c) axis[c] = 1.0f;
+                for (int iteration = 0; iteration < 8; ++iteration) {
+                    float next[N] = {};
+                    for (int r = 0; r < N; ++r)
+                        for (int c = 0; c < N; ++c) next[r] += covariance[r][c] * axis[c];
+                    float length = 0.0f;
+                    for (int c = 0; c < N; ++c) length += next[c] * next[c];
+                    // A flat block has no axis, any direction works
+                    if (length < 1e-12f) return;
+                    length = 1.0f / std::sqrt(length);
+                    for (int c = 0; c < N; ++c) axis[c] = next[c] * length;
+                }
+            }
+
+            // Points with the lowest and highest projection on the axis
+            template<int N>
+            void ProjectExtremes(const float (*points)[N], int count, const float* axis, float* low, float* high)
+            {
+                float minDot = 1e30f, maxDot = -1e30f;
+                int minIndex = 0, maxIndex = 0;
+                for (int i = 0; i < count; ++i) {
+                    float dot = 0.0f;
+                    for (int c = 0; c < N; ++c) dot += points[i][c] * axis[c];
+                    if (dot < minDot) { minDot = dot; minIndex = i; }
+                    if (dot > maxDot) { maxDot = dot; maxIndex = i; }
+                }
+                for (int c = 0; c < N; ++c) {
+                    low[c] = points[minIndex][c];
+                    high[c] = points[maxIndex][c];
+                }
+            }
+
+            // Writes count bits of value, LSB first, into a zeroed block
+            struct BitWriter
+            {
+                uint8_t* out;
+                uint32_t bit = 0;
+
+                void write(uint32_t value, uint32_t count)
+                {
+                    for (uint32_t i = 0; i < count; ++i, ++bit)
+                        if ((value >> i) & 1u) out[bit >> 3] |= uint8_t(1u << (bit & 7));
+                }
+            };
+
+            // ---- BC1 colour -------------------------------------------------------------------
+
+            uint16_t Pack565(const float* color)
+            {
+                int r = std::clamp(int(color[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+                int g = std::clamp(int(color[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+                int b = std::clamp(int(color[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+                return uint16_t((r << 11) | (g << 5) | b);
+            }
+
+            void Unpack565(uint16_t packed, int* color)
+            {
+                int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+                color[0] = (r << 3) | (r >> 2);
+                color[1] = (g << 2) | (g >> 4);
+                color[2] = (b << 3) | (b >> 2);
+            }
+
+            // Picks the nearest palette entry per pixel, returns the squared error
+            int PickColorIndices(uint16_t c0, uint16_t c1, bool threeColor, const uint8_t* rgba,
+                                 const bool* transparent, uint32_t& indices)
+            {
+                int palette[4][3];
+                Unpack565(c0, palette[0]);
+                Unpack565(c1, palette[1]);
+                for (int c = 0; c < 3; ++c) {
+                    if (threeColor) {
+                        palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                        palette[3][c] = 0;
+                    }
+                    else {
+                        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                    }
+                }
+
+                const int entries = threeColor ? 3 : 4;
+                int error = 0;
+                indices = 0;
+                for (int i = 0; i < 16; ++i) {
+                    if (transparent[i]) { indices |= 3u << (2 * i); continue; }
+                    int best = 0, bestError = 1 << 30;
+                    for (int e = 0; e < entries; ++e) {
+                        int dr = rgba[i * 4 + 0] - palette[e][0];
+                        int dg = rgba[i * 4 + 1] - palette[e][1];
+                        int db = rgba[i * 4 + 2] - palette[e][2];
+                        int d = dr * dr + dg * dg + db * db;
+                        if (d < bestError) { bestError = d; best = e; }
+                    }
+                    indices |= uint32_t(best) << (2 * i);
+                    error += bestError;
+                }
+                return error;
+            }
+
+            // Orders the endpoints for the wanted mode and picks indices. Equal endpoints always decode
+            // as three colour mode, where index 3 is black, so they use index 0 only.
+            int FinishColorBlock(uint16_t& c0, uint16_t& c1, bool threeColor, const uint8_t* rgba,
+                                 const bool* transparent, uint32_t& indices)
+            {
+                if (threeColor ? c0 > c1 : c0 < c1) std::swap(c0, c1);
+                if (c0 == c1 && !threeColor) {
+                    indices = 0;
+                    int error = 0, color[3];
+                    Unpack565(c0, color);
+                    for (int i = 0; i < 16; ++i)
+                        for (int c = 0; c < 3; ++c) error += (rgba[i * 4 + c] - color[c]) * (rgba[i * 4 + c] - color[c]);
+                    return error;
+                }
+                return PickColorIndices(c0, c1, threeColor, rgba, transparent, indices);
+            }
+
+            // Least squares endpoints for fixed four colour indices, as in van Waveren's real-time DXT
+            bool RefineColorEndpoints(const uint8_t* rgba, uint32_t indices, float* high, float* low)
+            {
+                static constexpr float kWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+                float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[3] = {}, bx[3] = {};
+                for (int i = 0; i < 16; ++i) {
+                    float a = kWeights[(indices >> (2 * i)) & 3u], b = 1.0f - a;
+                    aa += a * a;
+                    bb += b * b;
+                    ab += a * b;
+                    for (int c = 0; c < 3; ++c) {
+                        ax[c] += a * rgba[i * 4 + c];
+                        bx[c] += b * rgba[i * 4 + c];
+                    }
+                }
+                float det = aa * bb - ab * ab;
+                if (std::fabs(det) < 1e-6f) return false;
+                det = 1.0f / det;
+                for (int c = 0; c < 3; ++c) {
+                    high[c] = (ax[c] * bb - bx[c] * ab) * det;
+                    low[c] = (bx[c] * aa - ax[c] * ab) * det;
+                }
+                return true;
+            }
+
+            void EncodeColorBlock(const uint8_t* rgba, uint8_t* out, bool allowTransparent)
+            {
+                bool transparent[16];
+                float points[16][3];
+                int opaque = 0;
+                for (int i = 0; i < 16; ++i) {
+                    transparent[i] = allowTransparent && rgba[i * 4 + 3] < 128;
+                    if (transparent[i]) continue;
+                    for (int c = 0; c < 3; ++c) points[opaque][c] = float(rgba[i * 4 + c]);
+                    ++opaque;
+                }
+
+                uint16_t c0 = 0, c1 = 0;
+                uint32_t indices = 0xFFFFFFFFu;
+                if (opaque > 0) {
+                    const bool threeColor = opaque < 16;
+                    float mean[3], axis[3], low[3], high[3];
+                    ComputeAxis<3>(points, opaque, mean, axis);
+                    ProjectExtremes<3>(points, opaque, axis, low, high);
+
+                    c0 = Pack565(high);
+                    c1 = Pack565(low);
+                    int error = FinishColorBlock(c0, c1, threeColor, rgba, transparent, indices);
+
+                    if (!threeColor && error > 0 && RefineColorEndpoints(rgba, indices, high, low)) {
+                        uint16_t r0 = Pack565(high), r1 = Pack565(low);
+                        uint32_t refined;
+                        if (FinishColorBlock(r0, r1, false, rgba, transparent, refined) < error) {
+                            c0 = r0;
+                            c1 = r1;
+                            indices = refined;
+                        }
+                    }
+                }
+
+                std::memcpy(out, &c0, 2);
+                std::memcpy(out + 2, &c1, 2);
+                std::memcpy(out + 4, &indices, 4);
+            }
+
+            // ---- BC4 single channel ------------------------------------------------------------
+
+            // Eight-value mode only: endpoints are the block's min and max
+            void EncodeChannelBlock(const uint8_t* rgba, int channel, uint8_t* out)
+            {
+                int low = 255, high = 0;
+                for (int i = 0; i < 16; ++i) {
+                    low = std::min<int>(low, rgba[i * 4 + channel]);
+                    high = std::max<int>(high, rgba[i * 4 + channel]);
+                }
+
+                std::memset(out, 0, 8);
+                out[0] = uint8_t(high);
+                out[1] = uint8_t(low);
+                if (high == low) return;
+
+                int palette[8];
+                palette[0] = high;
+                palette[1] = low;
+                for (int k = 2; k < 8; ++k) palette[k] = ((8 - k) * high + (k - 1) * low) / 7;
+
+                BitWriter writer{ out + 2 };
+                for (int i = 0; i < 16; ++i) {
+                    int value = rgba[i * 4 + channel];
+                    int best = 0, bestError = 1 << 30;
+                    for (int k = 0; k < 8; ++k) {
+                        int d = std::abs(value - palette[k]);
+                        if (d < bestError) { bestError = d; best = k; }
+                    }
+                    writer.write(uint32_t(best), 3);
+                }
+            }
+
+            // ---- BC7 mode 6 -------------------------------------------------------------------
+
+            // Mode 6: one subset, RGBA endpoints with 7 bits per channel plus a p-bit per endpoint,
+            // and 4-bit indices. Covers every block with a single colour line, alpha included.
+            constexpr int kBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+            // Picks the p-bit that reconstructs the endpoint best, returns 7-bit channels
+            uint32_t QuantizeBC7Endpoint(const float* endpoint, int* quantized)
+            {
+                uint32_t bestBit = 0;
+                float bestError = 1e30f;
+                for (uint32_t bit = 0; bit < 2; ++bit) {
+                    int candidate[4];
+                    float error = 0.0f;
+                    for (int c = 0; c < 4; ++c) {
+                        candidate[c] = std::clamp(int((endpoint[c] - float(bit)) * 0.5f + 0.5f), 0, 127);
+                        float d = float((candidate[c] << 1) | int(bit)) - endpoint[c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        bestBit = bit;
+                        std::memcpy(quantized, candidate, sizeof(candidate));
+                    }
+                }
+                return bestBit;
+            }
+
+            void EncodeBC7Block(const uint8_t* rgba, uint8_t* out)
+            {
+                float points[16][4];
+                for (int i = 0; i < 16; ++i)
+                    for (int c = 0; c < 4; ++c) points[i][c] = float(rgba[i * 4 + c]);
+
+                float mean[4], axis[4], low[4], high[4];
+                ComputeAxis<4>(points, 16, mean, axis);
+                ProjectExtremes<4>(points, 16, axis, low, high);
+
+                int q0[4], q1[4];
+                uint32_t p0 = QuantizeBC7Endpoint(low, q0);
+                uint32_t p1 = QuantizeBC7Endpoint(high, q1);
+
+                int palette[16][4];
+                for (int k = 0; k < 16; ++k) {
+                    for (int c = 0; c < 4; ++c) {
+                        int e0 = (q0[c] << 1) | int(p0), e1 = (q1[c] << 1) | int(p1);
+                        palette[k][c] = ((64 - kBC7Weights[k]) * e0 + kBC7Weights[k] * e1 + 32) >> 6;
+                    }
+                }
+
+                int indices[16];
+                for (int i = 0; i < 16; ++i) {
+                    int best = 0, bestError = 1 << 30;
+                    for (int k = 0; k < 16; ++k) {
+                        int d = 0;
+                        for (int c = 0; c < 4; ++c) d += (rgba[i * 4 + c] - palette[k][c]) * (rgba[i * 4 + c] - palette[k][c]);
+                        if (d < bestError) { bestError = d; best = k; }
+                    }
+                    indices[i] = best;
+                }
+
+                // The first index is stored with 3 bits, so its top bit must be 0
+                if (indices[0] >= 8) {
+                    std::swap(q0, q1);
+                    std::swap(p0, p1);
+                    for (int& index : indices) index = 15 - index;
+                }
+
+                std::memset(out, 0, 16);
+                BitWriter writer{ out };
+                writer.write(1u << 6, 7);
+                for (int c = 0; c < 4; ++c) {
+                    writer.write(uint32_t(q0[c]), 7);
+                    writer.write(uint32_t(q1[c]), 7);
+                }
+                writer.write(p0, 1);
+                writer.write(p1, 1);
+                writer.write(uint32_t(indices[0]), 3);
+                for (int i = 1; i < 16; ++i) writer.write(uint32_t(indices[i]), 4);
+            }
+
+            // Gathers a 4x4 block as RGBA, repeating the last row and column past the edges
+            void FetchBlock(const uint8_t* pixels, int width, int height, int channels, int blockX, int blockY, uint8_t* rgba)
+            {
+                for (int y = 0; y < 4; ++y) {
+                    int sy = std::min(blockY * 4 + y, height - 1);
+                    for (int x = 0; x < 4; ++x) {
+                        int sx = std::min(blockX * 4 + x, width - 1);
+                        const uint8_t* source = pixels + (size_t(sy) * size_t(width) + size_t(sx)) * size_t(channels);
+                        uint8_t* target = rgba + (y * 4 + x) * 4;
+                        switch (channels) {
+                        case 1: target[0] = target[1] = target[2] = source[0]; target[3] = 255; break;
+                        case 2: target[0] = source[0]; target[1] = source[1]; target[2] = 0; target[3] = 255; break;
+                        case 3: target[0] = source[0]; target[1] = source[1]; target[2] = source[2]; target[3] = 255; break;
+                        default: std::memcpy(target, source, 4); break;
+                        }
+                    }
+                }
+            }
+        }
+
+        uint32_t BlockBytes(BlockFormat format)
+        {
+            switch (format) {
+            case BlockFormat::BC1:
+            case BlockFormat::BC4:
+                return 8;
+            default:
+                return 16;
+            }
+        }
+
+        bool HasSrgbVariant(BlockFormat format)
+        {
+            return format == BlockFormat::BC1 || format == BlockFormat::BC3 || format == BlockFormat::BC7;
+        }
+
+        size_t CompressedSize(BlockFormat format, int width, int height)
+        {
+            size_t blocksX = (size_t(std::max(width, 1)) + 3) / 4;
+            size_t blocksY = (size_t(std::max(height, 1)) + 3) / 4;
+            return blocksX * blocksY * BlockBytes(format);
+        }
+
+        void EncodeBlock(BlockFormat format, const uint8_t* rgba, uint8_t* out)
+        {
+            switch (format) {
+            case BlockFormat::BC1:
+                EncodeColorBlock(rgba, out, true);
+                break;
+            case BlockFormat::BC3:
+                EncodeChannelBlock(rgba, 3, out);
+                EncodeColorBlock(rgba, out + 8, false);
+                break;
+            case BlockFormat::BC4:
+                EncodeChannelBlock(rgba, 0, out);
+                break;
+            case BlockFormat::BC5:
+                EncodeChannelBlock(rgba, 0, out);
+                EncodeChannelBlock(rgba, 1, out + 8);
+                break;
+            case BlockFormat::BC7:
+                EncodeBC7Block(rgba, out);
+                break;
+            }
+        }
+
+        void EncodeImage(BlockFormat format, const uint8_t* pixels, int width, int height, int channels,
+                         uint8_t* out, Core::ThreadPool* pool)
+        {
+            if (width <= 0 || height <= 0 || channels < 1 || channels > 4) return;
+
+            const int blocksX = (width + 3) / 4;
+            const int blocksY = (height + 3) / 4;
+            const size_t blockBytes = BlockBytes(format);
+
+            auto encodeRow = [&](size_t blockY) {
+                uint8_t rgba[64];
+                uint8_t* target = out + blockY * size_t(blocksX) * blockBytes;
+                for (int blockX = 0; blockX < blocksX; ++blockX, target += blockBytes) {
+                    FetchBlock(pixels, width, height, channels, blockX, int(blockY), rgba);
+                    EncodeBlock(format, rgba, target);
+                }
+            };
+
+            if (pool) pool->parallelFor(size_t(blocksY), encodeRow);
+            else for (int blockY = 0; blockY < blocksY; ++blockY) encodeRow(size_t(blockY));
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../Core/ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Nyx {
+
+    namespace Image {
+        // GPU block compression formats. Each one encodes 4x4 pixel blocks to a fixed number of bytes.
+        enum class BlockFormat : uint32_t {
+            BC1 = 1,  // RGB with 1-bit alpha, 8 bytes per block (4 bits per pixel)
+            BC3,      // RGBA: BC1 colour plus a BC4 alpha block, 16 bytes per block
+            BC4,      // R only, 8 bytes per block. Masks, roughness, height maps.
+            BC5,      // RG, 16 bytes per block. Tangent space normal maps.
+            BC7,      // RGBA, 16 bytes per block, best quality. The encoder only uses mode 6.
+        };
+
+        NYX_API uint32_t BlockBytes(BlockFormat format);
+        // BC1, BC3 and BC7 have sRGB GL formats; BC4 and BC5 hold data and are always linear
+        NYX_API bool HasSrgbVariant(BlockFormat format);
+        NYX_API size_t CompressedSize(BlockFormat format, int width, int height);
+
+        // Encodes one block from 16 RGBA pixels (row major, 64 bytes). out receives BlockBytes(format) bytes.
+        NYX_API void EncodeBlock(BlockFormat format, const uint8_t* rgba, uint8_t* out);
+
+        // Encodes a whole image of 1-4 channels to CompressedSize(format, width, height) bytes at out.
+        // One-channel images encode as grey; partial blocks on the right and bottom edges repeat the
+        // last column and row. Block rows are spread over the pool when one is given.
+        NYX_API void EncodeImage(BlockFormat format, const uint8_t* pixels, int width, int height, int channels,
+                                 uint8_t* out, Core::ThreadPool* pool = nullptr);
+    }
+}
@@ -1,24 +1,287 @@
 ﻿#include "ImageLoader.h"
+#include "../Core/Hash.h"
+#include "../IO/MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <filesystem>
 
 
 namespace Nyx {
     namespace Image
     { 
+        namespace
+        {
+            using Clock = std::chrono::steady_clock;
+
+            double ElapsedMs(Clock::time_point start)
+            {
+                return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            }
+
+            uint64_t CompressOptionsKey(BlockFormat format, bool flip, const MipBuildOptions& mips)
+            {
+                return Core::HashCombine((uint64_t(format) << 1) | (flip ? 1u : 0u), mips.key());
+            }
+        }
+
         bool Loader::LoadToTexture(Nyx::Renderer::GL::Texture2D& texture, const std::string& path, bool flip)
         {
-            
-                int width, height, channels;
-				stbi_set_flip_vertically_on_load(flip); // Flip the image vertically on load for opengl
-                unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
-                if (!data) {
+            DecodedImage image;
+            if (!Decode(path, image, flip)) {
+                std::cerr << "Failed to load texture from: " << path << "\n";
+                return false;
+            }
+
+            return texture.setData(image.width, image.height, image.channels, image.pixels.get());
+        }
+
+        bool Loader::Decode(const std::string& path, DecodedImage& image, bool flip)
+        {
+            // Decode straight from the mapped file instead of through stdio's buffered reads
+            image.path = path;
+            IO::MappedFile file;
+            if (!file.open(path, IO::AccessPattern::Sequential) || file.size() == 0 || file.size() > INT_MAX)
+                return false;
+
+            // Flip the image vertically on load for opengl, without touching other threads' setting
+            stbi_set_flip_vertically_on_load_thread(flip);
+            image.pixels.reset(stbi_load_from_memory(file.data(), static_cast<int>(file.size()),
+                                                     &image.width, &image.height, &image.channels, 0));
+            return image.isValid();
+        }
+
+        std::vector<DecodedImage> Loader::DecodeBatch(const std::vector<std::string>& paths, bool flip,
+                                                      BatchStats* stats, Core::ThreadPool& pool)
+        {
+            std::vector<DecodedImage> images(paths.size());
+            std::atomic<size_t> fileBytes{ 0 };
+
+            auto start = Clock::now();
+            pool.parallelFor(paths.size(), [&](size_t i) {
+                if (Decode(paths[i], images[i], flip) && stats) {
+                    std::error_code ec;
+                    uintmax_t size = std::filesystem::file_size(paths[i], ec);
+                    if (!ec) fileBytes.fetch_add(static_cast<size_t>(size), std::memory_order_relaxed);
+                }
+            });
+
+            if (stats) {
+                stats->decodeMs = ElapsedMs(start);
+                stats->threads = pool.getThreadCount() + 1;
+                stats->images = paths.size();
+                stats->fileBytes = fileBytes.load();
+                stats->failed = 0;
+                stats->decodedBytes = 0;
+                for (const DecodedImage& image : images) {
+                    if (image.isValid()) stats->decodedBytes += image.sizeBytes();
+                    else ++stats->failed;
+                }
+            }
+            return images;
+        }
+
+        size_t Loader::LoadToTextures(Nyx::Renderer::GL::Texture2D* const* textures,
+                                      const std::vector<std::string>& paths, bool flip,
+                                      BatchStats* stats, Core::ThreadPool& pool)
+        {
+            std::vector<DecodedImage> images = DecodeBatch(paths, flip, stats, pool);
+
+            auto start = Clock::now();
+            size_t loaded = 0;
+            for (size_t i = 0; i < images.size(); ++i) {
+                if (!images[i].isValid()) {
+                    std::cerr << "Failed to load texture from: " << paths[i] << "\n";
+                    continue;
+                }
+                if (textures[i]->setData(images[i].width, images[i].height, images[i].channels, images[i].pixels.get()))
+                    ++loaded;
+                images[i].pixels.reset();
+            }
+            if (stats) stats->uploadMs = ElapsedMs(start);
+            return loaded;
+        }
+
+        GLenum Loader::GetGLFormat(BlockFormat format, bool srgb)
+        {
+            switch (format) {
+            case BlockFormat::BC1: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case BlockFormat::BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case BlockFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+            case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+            case BlockFormat::BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+            }
+            return 0;
+        }
+
+        bool Loader::Compress(const DecodedImage& image, BlockFormat format, CompressedImage& compressed,
+                              const MipBuildOptions& mips, Core::ThreadPool* pool)
+        {
+            // Encoding sRGB bytes into a format sampled as linear would skip the decode
+            MipBuildOptions options = mips;
+            options.srgb = mips.srgb && HasSrgbVariant(format);
+
+            MipChain chain;
+            if (!image.isValid() || !BuildMipChain(image.pixels.get(), image.width, image.height, image.channels, chain, options, pool))
+                return false;
+
+            compressed.format = format;
+            compressed.srgb = options.srgb;
+            compressed.width = image.width;
+            compressed.height = image.height;
+            compressed.levels.resize(chain.levels.size());
+
+            size_t dataSize = 0;
+            for (size_t level = 0; level < chain.levels.size(); ++level) {
+                CompressedLevel& entry = compressed.levels[level];
+                entry.width = chain.levels[level].width;
+                entry.height = chain.levels[level].height;
+                entry.offset = dataSize;
+                entry.size = CompressedSize(format, entry.width, entry.height);
+                dataSize += entry.size;
+            }
+            compressed.data.resize(dataSize);
+
+            for (size_t level = 0; level < chain.levels.size(); ++level) {
+                const MipLevel& source = chain.levels[level];
+                EncodeImage(format, source.pixels.data(), source.width, source.height, chain.channels,
+                            compressed.data.data() + compressed.levels[level].offset, pool);
+            }
+            return true;
+        }
+
+        bool Loader::UploadCompressed(Nyx::Renderer::GL::Texture2D& texture, const CompressedImage& compressed)
+        {
+            const GLenum glFormat = GetGLFormat(compressed.format, compressed.srgb);
+            if (!compressed.isValid() || glFormat == 0)
+                return false;
+
+            const int levels = static_cast<int>(compressed.levels.size());
+            const bool matches = texture.hasStorage() && texture.getInternalFormat() == glFormat &&
+                                 texture.getWidth() == compressed.width && texture.getHeight() == compressed.height &&
+                                 texture.getLevels() >= levels;
+            if (!matches && !texture.allocateStorage(compressed.width, compressed.height, glFormat, levels))
+                return false;
+
+            for (int level = 0; level < levels; ++level) {
+                const CompressedLevel& entry = compressed.levels[size_t(level)];
+                if (!texture.setCompressedData(level, entry.width, entry.height, glFormat,
+                                               compressed.levelData(size_t(level)), static_cast<GLsizei>(entry.size)))
+                    return false;
+            }
+            return true;
+        }
+
+        bool Loader::LoadCompressedToTexture(Nyx::Renderer::GL::Texture2D& texture, const std::string& path,
+                                             BlockFormat format, const std::string& cacheDirectory,
+                                             bool flip, const MipBuildOptions& mips, CompressedLoadStats* stats)
+        {
+            CompressedLoadStats local;
+            CompressedLoadStats& s = stats ? *stats : local;
+            s = {};
+            auto totalStart = Clock::now();
+
+            // The key hashes the encoded source file, so the file is read once for both the key and the decode
+            auto start = Clock::now();
+            IO::MappedFile file;
+            if (!file.open(path, IO::AccessPattern::Sequential) || file.size() == 0 || file.size() > INT_MAX) {
+                std::cerr << "Failed to load texture from: " << path << "\n";
+                return false;
+            }
+            const uint64_t optionsKey = CompressOptionsKey(format, flip, mips);
+            const uint64_t key = TextureCache::ComputeKey(file.data(), file.size(), optionsKey);
+            const std::string cachePath = TextureCache::GetCachePath(path, cacheDirectory, optionsKey);
+            s.readMs = ElapsedMs(start);
+
+            CompressedImage compressed;
+            start = Clock::now();
+            s.cacheHit = TextureCache::Load(cachePath, key, compressed);
+            if (s.cacheHit) {
+                s.cacheMs = ElapsedMs(start);
+            }
+            else {
+                start = Clock::now();
+                DecodedImage image;
+                stbi_set_flip_vertically_on_load_thread(flip);
+                image.path = path;
+                image.pixels.reset(stbi_load_from_memory(file.data(), static_cast<int>(file.size()),
+                                                         &image.width, &image.height, &image.channels, 0));
+                s.decodeMs = ElapsedMs(start);
+                if (!image.isValid()) {
                     std::cerr << "Failed to load texture from: " << path << "\n";
                     return false;
                 }
 
-                texture.setData(width, height, channels, data);
-                stbi_image_free(data);
-                return true;
+                start = Clock::now();
+                if (!Compress(image, format, compressed, mips)) {
+                    std::cerr << "Failed to compress texture: " << path << "\n";
+                    return false;
+                }
+                s.encodeMs = ElapsedMs(start);
+
+                // A failed cache write only costs the next load an encode; Save reports it
+                start = Clock::now();
+                TextureCache::Save(cachePath, key, compressed);
+                s.cacheMs = ElapsedMs(start);
+            }
+            file.close();
+
+            start = Clock::now();
+            if (!UploadCompressed(texture, compressed)) {
+                std::cerr << "Failed to upload compressed texture: " << path << "\n";
+                return false;
+            }
+            s.uploadMs = ElapsedMs(start);
+
+            for (const CompressedLevel& level : compressed.levels)
+                s.uncompressedBytes += size_t(level.width) * size_t(level.height) * 4;
+            s.compressedBytes = compressed.data.size();
+            s.totalMs = ElapsedMs(totalStart);
+            return true;
+        }
+
+        bool Loader::UploadMipChain(Nyx::Renderer::GL::Texture2D& texture, const MipChain& chain)
+        {
+            using Nyx::Renderer::GL::Texture2D;
+            if (!chain.isValid())
+                return false;
+
+            GLenum internalFormat = Texture2D::InternalFormatForChannels(chain.channels);
+            if (chain.srgb && chain.channels == 3) internalFormat = GL_SRGB8;
+            if (chain.srgb && chain.channels == 4) internalFormat = GL_SRGB8_ALPHA8;
+
+            const MipLevel& base = chain.levels[0];
+            const int levels = static_cast<int>(chain.levels.size());
+            const bool matches = texture.hasStorage() && texture.getInternalFormat() == internalFormat &&
+                                 texture.getWidth() == base.width && texture.getHeight() == base.height &&
+                                 texture.getLevels() >= levels;
+            if (!matches && !texture.allocateStorage(base.width, base.height, internalFormat, levels))
+                return false;
 
+            // Levels are tightly packed, odd widths of RGB rows are not 4-byte aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            const GLenum format = Texture2D::FormatForChannels(chain.channels);
+            for (int level = 0; level < levels; ++level) {
+                const MipLevel& entry = chain.levels[size_t(level)];
+                texture.setSubData(level, 0, 0, entry.width, entry.height, format, GL_UNSIGNED_BYTE, entry.pixels.data());
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            return true;
+        }
+
+        bool Loader::LoadToTexture(Nyx::Renderer::GL::Texture2D& texture, const std::string& path,
+                                   const MipBuildOptions& mips, bool flip)
+        {
+            DecodedImage image;
+            MipChain chain;
+            if (!Decode(path, image, flip) ||
+                !BuildMipChain(image.pixels.get(), image.width, image.height, image.channels, chain, mips)) {
+                std::cerr << "Failed to load texture from: " << path << "\n";
+                return false;
+            }
+            image.pixels.reset();
+            return UploadMipChain(texture, chain);
         }
 
     }
@@ -1,18 +1,106 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <iostream>
+#include <vector>
 #include "../vendor/stb_image.h"
 #include "../Renderer/GL/Texture2D.h"
+#include "../Core/ThreadPool.h"
 #include "../NyxAPI.h"
+#include "BlockCompression.h"
+#include "MipBuilder.h"
+#include "TextureCache.h"
 namespace Nyx {
 
     namespace Image {
+        // Pixels decoded by stb_image, freed with stbi_image_free
+        struct NYX_API DecodedImage {
+            struct PixelDeleter {
+                void operator()(unsigned char* pixels) const { stbi_image_free(pixels); }
+            };
+
+            std::string path;
+            int width = 0;
+            int height = 0;
+            int channels = 0;
+            std::unique_ptr<unsigned char, PixelDeleter> pixels;
+
+            inline bool isValid() const { return pixels != nullptr; }
+            inline size_t sizeBytes() const { return size_t(width) * size_t(height) * size_t(channels); }
+        };
+
+        struct NYX_API BatchStats {
+            size_t images = 0;
+            size_t failed = 0;
+            size_t fileBytes = 0;      // Compressed input
+            size_t decodedBytes = 0;   // Pixels produced
+            unsigned int threads = 0;  // Threads that decoded, the calling thread included
+            double decodeMs = 0.0;     // Wall time of the parallel decode
+            double uploadMs = 0.0;     // GL thread time spent in setData (LoadToTextures only)
+
+            inline double imagesPerSecond() const { return decodeMs > 0.0 ? images * 1000.0 / decodeMs : 0.0; }
+            inline double decodedMegabytesPerSecond() const { return decodeMs > 0.0 ? decodedBytes / (decodeMs * 1000.0) : 0.0; }
+            inline double fileMegabytesPerSecond() const { return decodeMs > 0.0 ? fileBytes / (decodeMs * 1000.0) : 0.0; }
+        };
+
+        struct NYX_API CompressedLoadStats {
+            bool cacheHit = false;
+            size_t uncompressedBytes = 0;  // RGBA8 size of the same mip chain
+            size_t compressedBytes = 0;
+            double readMs = 0.0;
+            double decodeMs = 0.0;         // Cold loads only
+            double encodeMs = 0.0;         // Cold loads only, mips included
+            double cacheMs = 0.0;          // Cache load on a hit, cache write on a miss
+            double uploadMs = 0.0;
+            double totalMs = 0.0;
+        };
+
         class NYX_API Loader {
         public:
             static bool LoadToTexture(Nyx::Renderer::GL::Texture2D& texture,
                                       const std::string& path, bool flip = true
 				);
+
+            // Thread-safe: the flip flag is set per thread, never through stb_image's global state
+            static bool Decode(const std::string& path, DecodedImage& image, bool flip = true);
+            // Decodes every path on the pool (the calling thread helps). Failed entries are invalid
+            // images in the same slot. Never touches GL, so it can run inside a pool task.
+            static std::vector<DecodedImage> DecodeBatch(const std::vector<std::string>& paths, bool flip = true,
+                                                         BatchStats* stats = nullptr,
+                                                         Core::ThreadPool& pool = Core::ThreadPool::GetShared());
+            // Decodes in parallel, then uploads textures[i] from paths[i] on the calling (GL) thread.
+            // Returns the number of textures loaded.
+            static size_t LoadToTextures(Nyx::Renderer::GL::Texture2D* const* textures,
+                                         const std::vector<std::string>& paths, bool flip = true,
+                                         BatchStats* stats = nullptr,
+                                         Core::ThreadPool& pool = Core::ThreadPool::GetShared());
+
+            // Builds the mip chain described by mips (maxLevels = 1 for none) and encodes every level.
+            // Never touches GL. Filtering and encoding run in parallel on the pool. mips.srgb only
+            // applies to BC1, BC3 and BC7; BC4 and BC5 data is always filtered linearly.
+            static bool Compress(const DecodedImage& image, BlockFormat format, CompressedImage& compressed,
+                                 const MipBuildOptions& mips = {},
+                                 Core::ThreadPool* pool = &Core::ThreadPool::GetShared());
+            // Allocates immutable storage for every level (unless the texture already matches) and
+            // uploads them with glCompressedTexSubImage2D.
+            static bool UploadCompressed(Nyx::Renderer::GL::Texture2D& texture, const CompressedImage& compressed);
+            // Loads the encoded texture from cacheDirectory when the cache matches the file, otherwise
+            // decodes, encodes and writes the cache for the next run. An empty cacheDirectory puts the
+            // cache next to the image.
+            static bool LoadCompressedToTexture(Nyx::Renderer::GL::Texture2D& texture, const std::string& path,
+                                                BlockFormat format, const std::string& cacheDirectory = "",
+                                                bool flip = true, const MipBuildOptions& mips = {},
+                                                CompressedLoadStats* stats = nullptr);
+
+            // Decodes, builds the mip chain on the CPU and uploads it into immutable storage
+            static bool LoadToTexture(Nyx::Renderer::GL::Texture2D& texture, const std::string& path,
+                                      const MipBuildOptions& mips, bool flip = true);
+            // Allocates immutable storage (GL_SRGB8 / GL_SRGB8_ALPHA8 for sRGB chains) and uploads each level
+            static bool UploadMipChain(Nyx::Renderer::GL::Texture2D& texture, const MipChain& chain);
+
+            // The SRGB variant when srgb is set and the format has one (see HasSrgbVariant)
+            static GLenum GetGLFormat(BlockFormat format, bool srgb = false);
         };
     }
 }
@@ -0,0 +1,377 @@
+#include "MipBuilder.h"
+#include "../Core/Hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NYX_MIP_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NYX_MIP_SSE2 1
+#endif
+
+namespace Nyx {
+    namespace Image
+    {
+        namespace
+        {
+            constexpr float kPi = 3.14159265358979f;
+            constexpr int kEncodeLutSize = 4096;
+            // Rows per parallel band are picked so a band covers about this many destination pixels
+            constexpr int kBandPixels = 16384;
+
+            struct SrgbTables
+            {
+                float decode[256];
+                uint8_t encode[kEncodeLutSize];
+
+                SrgbTables()
+                {
+                    for (int i = 0; i < 256; ++i) {
+                        float c = i / 255.0f;
+                        decode[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                    }
+                    for (int i = 0; i < kEncodeLutSize; ++i) {
+                        float l = i / float(kEncodeLutSize - 1);
+                        float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                        encode[i] = static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+                    }
+                }
+            };
+
+            const SrgbTables& GetSrgbTables()
+            {
+                static const SrgbTables tables;
+                return tables;
+            }
+
+            // Separable 2:1 kernel: destination texel x reads source texels 2x + first ... 2x + first + taps - 1
+            struct Kernel
+            {
+                int first = 0;
+                std::vector<float> weights;
+            };
+
+            // Modified Bessel function of the first kind, order 0
+            float BesselI0(float x)
+            {
+                float sum = 1.0f, term = 1.0f;
+                for (int k = 1; k < 32; ++k) {
+                    term *= (x / (2.0f * k)) * (x / (2.0f * k));
+                    sum += term;
+                    if (term < sum * 1e-8f) break;
+                }
+                return sum;
+            }
+
+            Kernel MakeKernel(MipFilter filter)
+            {
+                Kernel kernel;
+                if (filter == MipFilter::Box) {
+                    kernel.first = 0;
+                    kernel.weights = { 0.5f, 0.5f };
+                    return kernel;
+                }
+
+                // Width and alpha as in NVTT's Kaiser mipmap filter, in destination texels
+                constexpr float kWidth = 3.0f, kAlpha = 4.0f;
+                const int radius = static_cast<int>(kWidth * 2.0f);
+                kernel.first = 1 - radius;
+                float sum = 0.0f;
+                for (int k = kernel.first; k <= radius; ++k) {
+                    // Source texel centre k + 0.5 against the destination centre at 1, in destination units
+                    float t = (k - 0.5f) * 0.5f;
+                    float sinc = std::fabs(t) < 1e-6f ? 1.0f : std::sin(kPi * t) / (kPi * t);
+                    float window = t / kWidth;
+                    float kaiser = BesselI0(kAlpha * std::sqrt(std::max(0.0f, 1.0f - window * window))) / BesselI0(kAlpha);
+                    kernel.weights.push_back(sinc * kaiser);
+                    sum += sinc * kaiser;
+                }
+                for (float& weight : kernel.weights) weight /= sum;
+                return kernel;
+            }
+
+            // A level being read: either the 8-bit source or a float RGBA level built before
+            struct Source
+            {
+                int width = 0;
+                int height = 0;
+                const uint8_t* bytes = nullptr;
+                int channels = 0;
+                const float* floats = nullptr;
+            };
+
+            // Converts 8-bit rows to float RGBA through one lookup table per channel
+            void ConvertRows(const Source& source, int y0, int y1, int alphaIndex, bool srgb, float* out)
+            {
+                static const struct LinearTable {
+                    float values[256];
+                    LinearTable() { for (int i = 0; i < 256; ++i) values[i] = i / 255.0f; }
+                } linear;
+                static const float zero[256] = {};
+
+                const float* tables[4];
+                for (int c = 0; c < 4; ++c) {
+                    if (c >= source.channels) tables[c] = zero;
+                    else tables[c] = (srgb && c != alphaIndex) ? GetSrgbTables().decode : linear.values;
+                }
+
+                const int channels = source.channels;
+                for (int y = y0; y < y1; ++y) {
+                    const uint8_t* row = source.bytes + size_t(y) * size_t(source.width) * size_t(channels);
+                    for (int x = 0; x < source.width; ++x, row += channels, out += 4) {
+                        out[0] = tables[0][row[0]];
+                        out[1] = tables[1][channels > 1 ? row[1] : 0];
+                        out[2] = tables[2][channels > 2 ? row[2] : 0];
+                        out[3] = tables[3][channels > 3 ? row[3] : 0];
+                    }
+                }
+            }
+
+            // acc[i] += weight * row[i]
+            void AccumulateRow(float* acc, const float* row, float weight, size_t count)
+            {
+                size_t i = 0;
+#if defined(NYX_MIP_AVX2)
+                const __m256 w8 = _mm256_set1_ps(weight);
+                for (; i + 8 <= count; i += 8)
+                    _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(w8, _mm256_loadu_ps(row + i))));
+#endif
+#if defined(NYX_MIP_SSE2)
+                const __m128 w4 = _mm_set1_ps(weight);
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(w4, _mm_loadu_ps(row + i))));
+#endif
+                for (; i < count; ++i) acc[i] += weight * row[i];
+            }
+
+            // Filters a vertically filtered source row down to the destination width
+            void FilterRowHorizontal(const float* acc, int sourceWidth, float* out, int width, const Kernel& kernel)
+            {
+                const int taps = static_cast<int>(kernel.weights.size());
+                const float* weights = kernel.weights.data();
+
+                auto filterTexel = [&](int x) {
+                    const int base = 2 * x + kernel.first;
+                    const bool inside = base >= 0 && base + taps <= sourceWidth;
+#if defined(NYX_MIP_SSE2)
+                    __m128 sum = _mm_setzero_ps();
+                    for (int k = 0; k < taps; ++k) {
+                        int sx = inside ? base + k : std::clamp(base + k, 0, sourceWidth - 1);
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(acc + size_t(sx) * 4)));
+                    }
+                    _mm_storeu_ps(out + size_t(x) * 4, sum);
+#else
+                    float sum[4] = {};
+                    for (int k = 0; k < taps; ++k) {
+                        int sx = inside ? base + k : std::clamp(base + k, 0, sourceWidth - 1);
+                        for (int c = 0; c < 4; ++c) sum[c] += weights[k] * acc[size_t(sx) * 4 + c];
+                    }
+                    std::memcpy(out + size_t(x) * 4, sum, sizeof(sum));
+#endif
+                };
+
+                int x = 0;
+#if defined(NYX_MIP_AVX2)
+                // Texels whose window starts left of the row need clamping
+                for (const int interior = std::min(width, (1 - kernel.first) / 2); x < interior; ++x) filterTexel(x);
+                // Two destination texels per iteration; their source windows are 2 texels (8 floats) apart
+                for (; x + 1 < width && 2 * x + kernel.first + 2 + taps <= sourceWidth; x += 2) {
+                    const float* window = acc + size_t(2 * x + kernel.first) * 4;
+                    __m256 sum = _mm256_setzero_ps();
+                    for (int k = 0; k < taps; ++k) {
+                        const float* p = window + size_t(k) * 4;
+                        __m256 v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 8), 1);
+                        sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[k]), v));
+                    }
+                    _mm256_storeu_ps(out + size_t(x) * 4, sum);
+                }
+#endif
+                for (; x < width; ++x) filterTexel(x);
+            }
+
+            // Vertical pass into a full-width row, then the horizontal pass, for rows [y0, y1)
+            void FilterBand(const Source& source, float* target, int width, int y0, int y1, const Kernel& kernel,
+                            int alphaIndex, bool srgb)
+            {
+                const int taps = static_cast<int>(kernel.weights.size());
+                const size_t rowFloats = size_t(source.width) * 4;
+
+                // 8-bit sources are converted once per band; neighbouring rows share most of their taps
+                const int rowBegin = std::max(2 * y0 + kernel.first, 0);
+                const int rowEnd = std::min(2 * (y1 - 1) + kernel.first + taps, source.height);
+                std::vector<float> converted;
+                if (!source.floats) {
+                    converted.resize(size_t(rowEnd - rowBegin) * rowFloats);
+                    ConvertRows(source, rowBegin, rowEnd, alphaIndex, srgb, converted.data());
+                }
+                auto row = [&](int y) {
+                    return source.floats ? source.floats + size_t(y) * rowFloats
+                                         : converted.data() + size_t(y - rowBegin) * rowFloats;
+                };
+
+                std::vector<float> acc(rowFloats);
+                for (int y = y0; y < y1; ++y) {
+                    std::fill(acc.begin(), acc.end(), 0.0f);
+                    for (int k = 0; k < taps; ++k) {
+                        int sy = std::clamp(2 * y + kernel.first + k, rowBegin, rowEnd - 1);
+                        AccumulateRow(acc.data(), row(sy), kernel.weights[size_t(k)], rowFloats);
+                    }
+                    FilterRowHorizontal(acc.data(), source.width, target + size_t(y) * size_t(width) * 4, width, kernel);
+                }
+            }
+
+            // Castano's alpha coverage preservation: binary search for the alpha scale that restores the
+            // coverage of level 0. Searches a histogram so each step does not rescan the level.
+            float CoverageScale(const float* pixels, size_t count, int alphaIndex, float cutoff, float target)
+            {
+                constexpr int kBins = 4096;
+                std::vector<uint32_t> histogram(kBins + 1, 0);
+                for (size_t i = 0; i < count; ++i) {
+                    float alpha = std::clamp(pixels[i * 4 + alphaIndex], 0.0f, 1.0f);
+                    ++histogram[size_t(alpha * kBins)];
+                }
+                // above[b]: texels in bin b or higher
+                for (int bin = kBins - 1; bin >= 0; --bin) histogram[size_t(bin)] += histogram[size_t(bin) + 1];
+
+                auto coverage = [&](float scale) {
+                    float threshold = cutoff / scale;
+                    if (threshold >= 1.0f) return 0.0f;
+                    return float(histogram[size_t(threshold * kBins) + 1]) / float(count);
+                };
+
+                float low = 0.0f, high = 4.0f;
+                for (int iteration = 0; iteration < 16; ++iteration) {
+                    float mid = 0.5f * (low + high);
+                    if (coverage(mid) < target) low = mid;
+                    else high = mid;
+                }
+                return 0.5f * (low + high);
+            }
+
+            void StoreRows(const float* pixels, MipLevel& level, int channels, int alphaIndex, bool srgb,
+                           float alphaScale, int y0, int y1)
+            {
+                const uint8_t* encode = GetSrgbTables().encode;
+                for (int y = y0; y < y1; ++y) {
+                    const float* in = pixels + size_t(y) * size_t(level.width) * 4;
+                    uint8_t* out = level.pixels.data() + size_t(y) * size_t(level.width) * size_t(channels);
+                    for (int x = 0; x < level.width; ++x) {
+                        for (int c = 0; c < channels; ++c) {
+                            float value = in[size_t(x) * 4 + c];
+                            if (c == alphaIndex) value *= alphaScale;
+                            value = std::clamp(value, 0.0f, 1.0f);
+                            out[size_t(x) * channels + c] = (srgb && c != alphaIndex)
+                                ? encode[static_cast<int>(value * (kEncodeLutSize - 1) + 0.5f)]
+                                : static_cast<uint8_t>(value * 255.0f + 0.5f);
+                        }
+                    }
+                }
+            }
+
+            // Runs fn(y0, y1) over bands of rows
+            template<typename F>
+            void ForEachBand(int width, int height, Core::ThreadPool* pool, F&& fn)
+            {
+                const int rowsPerBand = std::max(1, kBandPixels / std::max(width, 1));
+                const int bands = (height + rowsPerBand - 1) / rowsPerBand;
+                auto band = [&](size_t i) {
+                    int y0 = int(i) * rowsPerBand;
+                    fn(y0, std::min(height, y0 + rowsPerBand));
+                };
+                if (pool && bands > 1) pool->parallelFor(size_t(bands), band);
+                else for (int i = 0; i < bands; ++i) band(size_t(i));
+            }
+        }
+
+        uint64_t MipBuildOptions::key() const
+        {
+            uint32_t coverageBits;
+            std::memcpy(&coverageBits, &alphaCoverage, sizeof(coverageBits));
+            uint64_t hash = Core::HashCombine(static_cast<uint64_t>(filter), srgb ? 1u : 0u);
+            hash = Core::HashCombine(hash, coverageBits);
+            return Core::HashCombine(hash, static_cast<uint64_t>(maxLevels));
+        }
+
+        size_t MipChain::sizeBytes() const
+        {
+            size_t size = 0;
+            for (const MipLevel& level : levels) size += level.pixels.size();
+            return size;
+        }
+
+        bool BuildMipChain(const uint8_t* pixels, int width, int height, int channels, MipChain& chain,
+                           const MipBuildOptions& options, Core::ThreadPool* pool)
+        {
+            if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4)
+                return false;
+
+            int levelCount = 1;
+            for (int size = std::max(width, height); size > 1; size >>= 1) ++levelCount;
+            if (options.maxLevels > 0) levelCount = std::min(levelCount, options.maxLevels);
+
+            // stb_image layouts: grey, grey + alpha, RGB, RGBA
+            const int alphaIndex = (channels == 2 || channels == 4) ? channels - 1 : -1;
+            const bool preserveCoverage = options.alphaCoverage > 0.0f && alphaIndex >= 0;
+            const Kernel kernel = MakeKernel(options.filter);
+
+            chain.channels = channels;
+            chain.srgb = options.srgb;
+            chain.levels.assign(size_t(levelCount), MipLevel{});
+            chain.levels[0].width = width;
+            chain.levels[0].height = height;
+            chain.levels[0].pixels.assign(pixels, pixels + size_t(width) * size_t(height) * size_t(channels));
+
+            float targetCoverage = 0.0f;
+            if (preserveCoverage) {
+                const uint8_t cutoff = static_cast<uint8_t>(std::clamp(options.alphaCoverage * 255.0f, 0.0f, 255.0f));
+                size_t covered = 0;
+                for (size_t i = 0, count = size_t(width) * size_t(height); i < count; ++i)
+                    covered += pixels[i * channels + alphaIndex] > cutoff ? 1 : 0;
+                targetCoverage = float(covered) / float(size_t(width) * size_t(height));
+            }
+
+            Source source{ width, height, pixels, channels, nullptr };
+            std::vector<float> current, next;
+            for (int levelIndex = 1; levelIndex < levelCount; ++levelIndex) {
+                MipLevel& level = chain.levels[size_t(levelIndex)];
+                level.width = std::max(source.width / 2, 1);
+                level.height = std::max(source.height / 2, 1);
+                level.pixels.resize(size_t(level.width) * size_t(level.height) * size_t(channels));
+                next.resize(size_t(level.width) * size_t(level.height) * 4);
+
+                ForEachBand(level.width, level.height, pool, [&](int y0, int y1) {
+                    FilterBand(source, next.data(), level.width, y0, y1, kernel, alphaIndex, options.srgb);
+                });
+
+                // Applied to the stored level only; the next level still filters the unscaled alpha
+                float alphaScale = 1.0f;
+                if (preserveCoverage) {
+                    alphaScale = CoverageScale(next.data(), size_t(level.width) * size_t(level.height), alphaIndex,
+                                               options.alphaCoverage, targetCoverage);
+                }
+                ForEachBand(level.width, level.height, pool, [&](int y0, int y1) {
+                    StoreRows(next.data(), level, channels, alphaIndex, options.srgb, alphaScale, y0, y1);
+                });
+
+                current.swap(next);
+                source = Source{ level.width, level.height, nullptr, 4, current.data() };
+            }
+            return true;
+        }
+
+        const char* GetMipBuilderSimd()
+        {
+#if defined(NYX_MIP_AVX2)
+            return "AVX2";
+#elif defined(NYX_MIP_SSE2)
+            return "SSE2";
+#else
+            return "scalar";
+#endif
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../Core/ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Nyx {
+
+    namespace Image {
+        enum class MipFilter : uint32_t {
+            Box,     // 2x2 average. Cheap, slightly blurry.
+            Kaiser,  // Kaiser-windowed sinc (width 3, alpha 4). Sharper minification with less aliasing.
+        };
+
+        struct NYX_API MipBuildOptions {
+            MipFilter filter = MipFilter::Box;
+            // RGB is sRGB encoded: filter in linear space and re-encode. Alpha is always linear.
+            bool srgb = false;
+            // When > 0, every level is rescaled so the fraction of texels with alpha above this cutoff
+            // matches level 0. Keeps alpha-tested foliage and fences from thinning out in the distance.
+            float alphaCoverage = 0.0f;
+            // 0 builds the full chain down to 1x1
+            int maxLevels = 0;
+
+            // Hash of the options, for cache keys
+            uint64_t key() const;
+        };
+
+        struct NYX_API MipLevel {
+            int width = 0;
+            int height = 0;
+            std::vector<uint8_t> pixels;  // Tightly packed, MipChain::channels per pixel
+        };
+
+        struct NYX_API MipChain {
+            int channels = 0;
+            bool srgb = false;
+            std::vector<MipLevel> levels; // Level 0 is a copy of the source
+
+            inline bool isValid() const { return !levels.empty(); }
+            size_t sizeBytes() const;
+        };
+
+        // Builds the mip chain of an 8-bit image with 1-4 channels on the CPU, so the result does not
+        // depend on the driver's glGenerateMipmap. Levels are built one after another; the rows of
+        // each level are split into bands filtered in parallel on the pool. Returns false on bad input.
+        NYX_API bool BuildMipChain(const uint8_t* pixels, int width, int height, int channels, MipChain& chain,
+                                   const MipBuildOptions& options = {},
+                                   Core::ThreadPool* pool = &Core::ThreadPool::GetShared());
+
+        // Instruction set the filters were compiled for: "AVX2", "SSE2" or "scalar"
+        NYX_API const char* GetMipBuilderSimd();
+    }
+}
@@ -0,0 +1,160 @@
+#include "TextureCache.h"
+#include "../Core/Hash.h"
+#include "../IO/MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Nyx {
+    namespace Image
+    {
+        namespace
+        {
+            constexpr uint32_t kMagic = 0x5458594E; // "NYXT"
+
+            struct CacheHeader
+            {
+                uint32_t magic;
+                uint32_t version;
+                uint64_t key;
+                uint32_t format;
+                uint32_t srgb;
+                uint32_t width;
+                uint32_t height;
+                uint32_t levelCount;
+            };
+
+            // Level table entry; data follows the table, levels in order
+            struct LevelHeader
+            {
+                uint32_t width;
+                uint32_t height;
+                uint64_t size;
+            };
+        }
+
+        uint64_t TextureCache::ComputeKey(const void* sourceData, size_t sourceSize, uint64_t optionsKey)
+        {
+            uint64_t key = Core::HashBytes(sourceData, sourceSize);
+            key = Core::HashCombine(key, sourceSize);
+            key = Core::HashCombine(key, optionsKey);
+            key = Core::HashCombine(key, kVersion);
+            return key;
+        }
+
+        std::string TextureCache::GetCachePath(const std::string& sourcePath, const std::string& cacheDirectory, uint64_t optionsKey)
+        {
+            std::error_code ec;
+            std::filesystem::path canonical = std::filesystem::weakly_canonical(sourcePath, ec);
+            if (ec)
+                canonical = std::filesystem::absolute(sourcePath, ec).lexically_normal();
+            const uint64_t hash = Core::HashCombine(Core::HashString(canonical.generic_string()), optionsKey);
+
+            char suffix[32];
+            std::snprintf(suffix, sizeof(suffix), ".%016llx.nyxtex", static_cast<unsigned long long>(hash));
+            if (cacheDirectory.empty())
+                return sourcePath + suffix;
+
+            std::filesystem::path fileName = std::filesystem::path(sourcePath).filename();
+            return (std::filesystem::path(cacheDirectory) / fileName).string() + suffix;
+        }
+
+        bool TextureCache::Load(const std::string& cachePath, uint64_t key, CompressedImage& image)
+        {
+            std::error_code ec;
+            if (!std::filesystem::exists(cachePath, ec))
+                return false;
+            IO::MappedFile file;
+            if (!file.open(cachePath, IO::AccessPattern::Sequential) || file.size() < sizeof(CacheHeader))
+                return false;
+
+            CacheHeader header;
+            std::memcpy(&header, file.data(), sizeof(header));
+            if (header.magic != kMagic || header.version != kVersion || header.key != key ||
+                header.format < uint32_t(BlockFormat::BC1) || header.format > uint32_t(BlockFormat::BC7) ||
+                header.srgb > 1 || (header.srgb && !HasSrgbVariant(static_cast<BlockFormat>(header.format))) ||
+                header.levelCount == 0 || header.levelCount > 32 ||
+                header.levelCount * sizeof(LevelHeader) > file.size() - sizeof(header))
+                return false;
+
+            CompressedImage loaded;
+            loaded.format = static_cast<BlockFormat>(header.format);
+            loaded.srgb = header.srgb != 0;
+            loaded.width = static_cast<int>(header.width);
+            loaded.height = static_cast<int>(header.height);
+            loaded.levels.resize(header.levelCount);
+
+            size_t offset = sizeof(header);
+            size_t dataSize = 0;
+            for (CompressedLevel& level : loaded.levels)
+            {
+                LevelHeader levelHeader;
+                std::memcpy(&levelHeader, file.data() + offset, sizeof(levelHeader));
+                offset += sizeof(levelHeader);
+                level.width = static_cast<int>(levelHeader.width);
+                level.height = static_cast<int>(levelHeader.height);
+                level.offset = dataSize;
+                level.size = static_cast<size_t>(levelHeader.size);
+                if (level.size != CompressedSize(loaded.format, level.width, level.height))
+                    return false;
+                dataSize += level.size;
+            }
+            if (dataSize != file.size() - offset)
+                return false;
+
+            loaded.data.assign(file.data() + offset, file.data() + offset + dataSize);
+            image = std::move(loaded);
+            return true;
+        }
+
+        bool TextureCache::Save(const std::string& cachePath, uint64_t key, const CompressedImage& image)
+        {
+            if (!image.isValid())
+                return false;
+
+            CacheHeader header = {};
+            header.magic = kMagic;
+            header.version = kVersion;
+            header.key = key;
+            header.format = static_cast<uint32_t>(image.format);
+            header.srgb = image.srgb ? 1u : 0u;
+            header.width = static_cast<uint32_t>(image.width);
+            header.height = static_cast<uint32_t>(image.height);
+            header.levelCount = static_cast<uint32_t>(image.levels.size());
+
+            std::error_code ec;
+            std::filesystem::path target(cachePath);
+            if (target.has_parent_path())
+                std::filesystem::create_directories(target.parent_path(), ec);
+
+            std::string tempPath = cachePath + ".tmp";
+            {
+                std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                for (const CompressedLevel& level : image.levels)
+                {
+                    LevelHeader levelHeader = { uint32_t(level.width), uint32_t(level.height), uint64_t(level.size) };
+                    out.write(reinterpret_cast<const char*>(&levelHeader), sizeof(levelHeader));
+                }
+                for (const CompressedLevel& level : image.levels)
+                    out.write(reinterpret_cast<const char*>(image.data.data() + level.offset), static_cast<std::streamsize>(level.size));
+                if (!out)
+                {
+                    std::cerr << "Failed to write texture cache: " << tempPath << "\n";
+                    return false;
+                }
+            }
+
+            std::filesystem::rename(tempPath, target, ec);
+            if (ec)
+            {
+                std::cerr << "Failed to write texture cache: " << cachePath << " (" << ec.message() << ")\n";
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+            return true;
+        }
+    }
+}
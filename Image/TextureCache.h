@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "BlockCompression.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Nyx {
+
+    namespace Image {
+        struct NYX_API CompressedLevel {
+            int width = 0;
+            int height = 0;
+            size_t offset = 0;   // Into CompressedImage::data
+            size_t size = 0;
+        };
+
+        // A block compressed image with its mip chain, level 0 first
+        struct NYX_API CompressedImage {
+            BlockFormat format = BlockFormat::BC1;
+            bool srgb = false;   // Levels hold sRGB-encoded colour, uploaded as the format's SRGB variant
+            int width = 0;
+            int height = 0;
+            std::vector<CompressedLevel> levels;
+            std::vector<uint8_t> data;
+
+            inline bool isValid() const { return !levels.empty(); }
+            inline const uint8_t* levelData(size_t level) const { return data.data() + levels[level].offset; }
+        };
+
+        // Versioned on-disk cache of encoded textures, mips included, in the spirit of DDS/KTX2.
+        // Like MeshCache, a file is only accepted when its key matches the hash of the source image and
+        // the encode options, so editing a texture falls back to decoding and encoding it again.
+        class NYX_API TextureCache {
+        public:
+            // Bump whenever the on-disk layout or the encoder output changes
+            static constexpr uint32_t kVersion = 3;
+
+            static uint64_t ComputeKey(const void* sourceData, size_t sourceSize, uint64_t optionsKey);
+            // "<file>.<hash>.nyxtex", the hash covering the canonical source path and the options, so
+            // same-named images from different folders, or one image loaded with different options,
+            // never share a file. An empty cacheDirectory stores it next to the source.
+            static std::string GetCachePath(const std::string& sourcePath, const std::string& cacheDirectory, uint64_t optionsKey);
+
+            // Reads the cache through a memory mapping. Returns false on a missing, stale or corrupt file.
+            static bool Load(const std::string& cachePath, uint64_t key, CompressedImage& image);
+            // Writes to a temporary file first so a crash never leaves a truncated cache behind.
+            static bool Save(const std::string& cachePath, uint64_t key, const CompressedImage& image);
+        };
+    }
+}
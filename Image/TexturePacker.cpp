@@ -0,0 +1,382 @@
+#include "TexturePacker.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <tuple>
+
+namespace Nyx {
+    namespace Image
+    {
+        namespace
+        {
+            using Clock = std::chrono::steady_clock;
+            using Nyx::Renderer::GL::Texture2D;
+            using Nyx::Renderer::GL::Texture2DArray;
+
+            double ElapsedMs(Clock::time_point start)
+            {
+                return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            }
+
+            // Skyline bottom-left rectangle packer (Jylanki, "A Thousand Ways to Pack the Bin").
+            // The skyline is a list of segments covering the full width, each at the height of the
+            // tallest rectangle below it.
+            class Skyline
+            {
+            public:
+                explicit Skyline(int size) : m_Size(size), m_Nodes{ { 0, 0, size } } {}
+
+                bool insert(int width, int height, int& x, int& y)
+                {
+                    int bestIndex = -1, bestTop = INT_MAX, bestWidth = INT_MAX, bestY = 0;
+                    for (int i = 0; i < static_cast<int>(m_Nodes.size()); ++i) {
+                        int top;
+                        if (!fits(i, width, height, top)) continue;
+                        if (top + height < bestTop || (top + height == bestTop && m_Nodes[size_t(i)].width < bestWidth)) {
+                            bestIndex = i;
+                            bestTop = top + height;
+                            bestWidth = m_Nodes[size_t(i)].width;
+                            bestY = top;
+                        }
+                    }
+                    if (bestIndex < 0) return false;
+
+                    x = m_Nodes[size_t(bestIndex)].x;
+                    y = bestY;
+                    m_Nodes.insert(m_Nodes.begin() + bestIndex, Node{ x, y + height, width });
+
+                    // Segments now under the new one shrink or disappear
+                    for (size_t i = size_t(bestIndex) + 1; i < m_Nodes.size();) {
+                        const int previousEnd = m_Nodes[i - 1].x + m_Nodes[i - 1].width;
+                        if (m_Nodes[i].x >= previousEnd) break;
+                        const int overlap = previousEnd - m_Nodes[i].x;
+                        m_Nodes[i].x += overlap;
+                        m_Nodes[i].width -= overlap;
+                        if (m_Nodes[i].width > 0) break;
+                        m_Nodes.erase(m_Nodes.begin() + std::ptrdiff_t(i));
+                    }
+                    for (size_t i = 0; i + 1 < m_Nodes.size();) {
+                        if (m_Nodes[i].y == m_Nodes[i + 1].y) {
+                            m_Nodes[i].width += m_Nodes[i + 1].width;
+                            m_Nodes.erase(m_Nodes.begin() + std::ptrdiff_t(i) + 1);
+                        }
+                        else {
+                            ++i;
+                        }
+                    }
+                    return true;
+                }
+
+            private:
+                struct Node { int x, y, width; };
+
+                // Lowest y a rectangle starting at node index can sit at
+                bool fits(int index, int width, int height, int& y) const
+                {
+                    if (m_Nodes[size_t(index)].x + width > m_Size) return false;
+                    y = 0;
+                    for (int remaining = width, i = index; remaining > 0; ++i) {
+                        y = std::max(y, m_Nodes[size_t(i)].y);
+                        if (y + height > m_Size) return false;
+                        remaining -= m_Nodes[size_t(i)].width;
+                    }
+                    return true;
+                }
+
+                int m_Size;
+                std::vector<Node> m_Nodes;
+            };
+
+            GLenum InternalFormatFor(int channels, bool srgb)
+            {
+                if (srgb && channels == 3) return GL_SRGB8;
+                if (srgb && channels == 4) return GL_SRGB8_ALPHA8;
+                return Texture2D::InternalFormatForChannels(channels);
+            }
+
+            // Grey and grey-alpha images go up as RGB and RGBA, the same texels atlas layers hold, so
+            // every layer samples alike and sRGB decoding applies to them too
+            int ArrayChannels(int channels)
+            {
+                return channels == 1 ? 3 : channels == 2 ? 4 : channels;
+            }
+
+            void ExpandGrey(const uint8_t* source, int channels, size_t texels, std::vector<uint8_t>& expanded)
+            {
+                const size_t outChannels = size_t(ArrayChannels(channels));
+                expanded.resize(texels * outChannels);
+                uint8_t* out = expanded.data();
+                for (size_t i = 0; i < texels; ++i, source += channels, out += outChannels) {
+                    out[0] = out[1] = out[2] = source[0];
+                    if (channels == 2) out[3] = source[1];
+                }
+            }
+
+            int LevelLimit(int configured, int width, int height)
+            {
+                const int full = Texture2D::MipLevelCount(width, height);
+                return configured > 0 ? std::min(configured, full) : full;
+            }
+
+            MipBuildOptions WithColorSpace(const MipBuildOptions& mips, bool srgb)
+            {
+                MipBuildOptions options = mips;
+                options.srgb = srgb;
+                return options;
+            }
+
+            // Builds the chain of one layer and uploads every level
+            size_t UploadLayer(Texture2DArray& array, int layer, const uint8_t* pixels, int width, int height,
+                               int channels, const MipBuildOptions& mips)
+            {
+                MipChain chain;
+                BuildMipChain(pixels, width, height, channels, chain, mips);
+                const GLenum format = Texture2D::FormatForChannels(channels);
+                for (size_t level = 0; level < chain.levels.size(); ++level) {
+                    const MipLevel& entry = chain.levels[level];
+                    array.setLayerData(layer, static_cast<int>(level), entry.width, entry.height, format, GL_UNSIGNED_BYTE,
+                                       entry.pixels.data());
+                }
+                return chain.sizeBytes();
+            }
+        }
+
+        TexturePacker::TexturePacker(const TexturePackerConfig& config)
+            : m_Config(config)
+        {}
+
+        uint32_t TexturePacker::addFile(const std::string& path, bool srgb)
+        {
+            std::unordered_map<std::string, uint32_t>& indices = m_PathIndices[srgb ? 1 : 0];
+            auto it = indices.find(path);
+            if (it != indices.end())
+                return it->second;
+
+            uint32_t index = static_cast<uint32_t>(m_Paths.size());
+            m_Paths.push_back(path);
+            m_Srgb.push_back(srgb ? 1 : 0);
+            m_Regions.emplace_back();
+            indices.emplace(path, index);
+            return index;
+        }
+
+        std::vector<MaterialRegions> TexturePacker::addMaterials(const std::vector<Material>& materials,
+                                                                 const std::string& directory)
+        {
+            auto add = [&](const std::string& texture, bool srgb) {
+                if (texture.empty()) return MaterialRegions::kNoRegion;
+                return addFile(directory.empty() ? texture : (std::filesystem::path(directory) / texture).string(), srgb);
+            };
+
+            // Specular and normal maps hold data, not colour
+            std::vector<MaterialRegions> regions(materials.size());
+            for (size_t i = 0; i < materials.size(); ++i) {
+                regions[i].diffuse = add(materials[i].diffuseTex, true);
+                regions[i].specular = add(materials[i].specularTex, false);
+                regions[i].normal = add(materials[i].normalTex, false);
+            }
+            return regions;
+        }
+
+        bool TexturePacker::build()
+        {
+            if (m_Built == m_Paths.size())
+                return true;
+
+            std::vector<std::string> paths(m_Paths.begin() + std::ptrdiff_t(m_Built), m_Paths.end());
+            BatchStats decodeStats;
+            std::vector<DecodedImage> decoded = Loader::DecodeBatch(paths, m_Config.flip, &decodeStats);
+            m_Stats.decodeMs += decodeStats.decodeMs;
+
+            auto start = Clock::now();
+            std::vector<PendingImage> pending;
+            pending.reserve(decoded.size());
+            for (size_t i = 0; i < decoded.size(); ++i) {
+                ++m_Stats.images;
+                if (!decoded[i].isValid()) {
+                    std::cerr << "TexturePacker: failed to load " << paths[i] << "\n";
+                    ++m_Stats.failed;
+                    continue;
+                }
+                const uint32_t region = static_cast<uint32_t>(m_Built + i);
+                pending.push_back(PendingImage{ region, m_Srgb[region] != 0, std::move(decoded[i]) });
+            }
+
+            const int padding = std::max(m_Config.padding, 0);
+            std::vector<PendingImage*> wholeLayers, atlasEntries[2];
+            for (PendingImage& entry : pending) {
+                const DecodedImage& image = entry.image;
+                const bool small = image.width <= m_Config.atlasMaxSize && image.height <= m_Config.atlasMaxSize &&
+                                   image.width + 2 * padding <= m_Config.atlasSize &&
+                                   image.height + 2 * padding <= m_Config.atlasSize;
+                (small ? atlasEntries[entry.srgb ? 1 : 0] : wholeLayers).push_back(&entry);
+            }
+
+            // Levels and rows are tightly packed
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            buildArrays(wholeLayers);
+            buildAtlases(atlasEntries[0], false);
+            buildAtlases(atlasEntries[1], true);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+            m_Built = m_Paths.size();
+            m_Stats.packMs += ElapsedMs(start);
+            return m_Stats.failed == 0;
+        }
+
+        void TexturePacker::buildArrays(std::vector<PendingImage*>& images)
+        {
+            // Same size, channel count and colour space share an array
+            std::map<std::tuple<int, int, int, bool>, std::vector<PendingImage*>> groups;
+            for (PendingImage* entry : images)
+                groups[{ entry->image.width, entry->image.height, ArrayChannels(entry->image.channels), entry->srgb }].push_back(entry);
+
+            const size_t maxLayers = static_cast<size_t>(Texture2DArray::MaxLayers());
+            for (auto& [key, group] : groups) {
+                const auto [width, height, channels, srgb] = key;
+                const int levels = LevelLimit(m_Config.mips.maxLevels, width, height);
+                const MipBuildOptions mips = WithColorSpace(m_Config.mips, srgb);
+
+                for (size_t first = 0; first < group.size(); first += maxLayers) {
+                    const size_t count = std::min(maxLayers, group.size() - first);
+                    auto array = std::make_unique<Texture2DArray>();
+                    array->allocateStorage(width, height, static_cast<int>(count), InternalFormatFor(channels, srgb), levels);
+                    array->setTextureParams();
+
+                    const uint32_t arrayIndex = static_cast<uint32_t>(m_Arrays.size());
+                    std::vector<uint8_t> expanded;
+                    for (size_t layer = 0; layer < count; ++layer) {
+                        PendingImage& entry = *group[first + layer];
+                        const uint8_t* pixels = entry.image.pixels.get();
+                        if (entry.image.channels != channels) {
+                            ExpandGrey(pixels, entry.image.channels, size_t(width) * size_t(height), expanded);
+                            pixels = expanded.data();
+                        }
+                        m_Stats.gpuBytes += UploadLayer(*array, static_cast<int>(layer), pixels, width, height, channels, mips);
+                        entry.image.pixels.reset();
+
+                        TextureRegion& region = m_Regions[entry.region];
+                        region = TextureRegion{};
+                        region.array = arrayIndex;
+                        region.layer = static_cast<uint32_t>(layer);
+                        region.width = static_cast<uint32_t>(width);
+                        region.height = static_cast<uint32_t>(height);
+                    }
+                    m_Stats.arrayLayers += count;
+                    ++m_Stats.arrays;
+                    m_Arrays.push_back(std::move(array));
+                }
+            }
+        }
+
+        void TexturePacker::buildAtlases(std::vector<PendingImage*>& images, bool srgb)
+        {
+            if (images.empty()) return;
+
+            // Tallest first keeps the skyline flat
+            std::sort(images.begin(), images.end(), [](const PendingImage* a, const PendingImage* b) {
+                if (a->image.height != b->image.height) return a->image.height > b->image.height;
+                return a->image.width > b->image.width;
+            });
+
+            const int size = m_Config.atlasSize;
+            const int padding = std::max(m_Config.padding, 0);
+            const size_t layerBytes = size_t(size) * size_t(size) * 4;
+
+            struct Placement { PendingImage* entry; size_t layer; int x, y; };
+            std::vector<Skyline> skylines;
+            std::vector<Placement> placements;
+            for (PendingImage* entry : images) {
+                const int width = entry->image.width + 2 * padding, height = entry->image.height + 2 * padding;
+                Placement placement{ entry, 0, 0, 0 };
+                bool placed = false;
+                for (size_t layer = 0; layer < skylines.size() && !placed; ++layer) {
+                    placed = skylines[layer].insert(width, height, placement.x, placement.y);
+                    placement.layer = layer;
+                }
+                if (!placed) {
+                    skylines.emplace_back(size);
+                    placement.layer = skylines.size() - 1;
+                    skylines.back().insert(width, height, placement.x, placement.y);
+                }
+                placements.push_back(placement);
+            }
+
+            // Every atlas layer is RGBA so all small textures share one binding. The padding repeats the
+            // edge texels, which keeps bilinear filtering clean for 1 + log2(padding) mip levels.
+            std::vector<std::vector<uint8_t>> layers(skylines.size(), std::vector<uint8_t>(layerBytes, 0));
+            size_t coveredTexels = 0;
+            for (const Placement& placement : placements) {
+                const DecodedImage& image = placement.entry->image;
+                const int channels = image.channels;
+                uint8_t* target = layers[placement.layer].data();
+                for (int ty = 0; ty < image.height + 2 * padding; ++ty) {
+                    const int sy = std::clamp(ty - padding, 0, image.height - 1);
+                    const uint8_t* sourceRow = image.pixels.get() + size_t(sy) * size_t(image.width) * size_t(channels);
+                    uint8_t* out = target + (size_t(placement.y + ty) * size_t(size) + size_t(placement.x)) * 4;
+                    for (int tx = 0; tx < image.width + 2 * padding; ++tx, out += 4) {
+                        const uint8_t* texel = sourceRow + size_t(std::clamp(tx - padding, 0, image.width - 1)) * size_t(channels);
+                        switch (channels) {
+                        case 1: out[0] = out[1] = out[2] = texel[0]; out[3] = 255; break;
+                        case 2: out[0] = out[1] = out[2] = texel[0]; out[3] = texel[1]; break;
+                        case 3: out[0] = texel[0]; out[1] = texel[1]; out[2] = texel[2]; out[3] = 255; break;
+                        default: std::memcpy(out, texel, 4); break;
+                        }
+                    }
+                }
+                coveredTexels += size_t(image.width) * size_t(image.height);
+            }
+
+            MipBuildOptions mips = WithColorSpace(m_Config.mips, srgb);
+            int paddedLevels = 1;
+            for (int p = padding; p > 1; p >>= 1) ++paddedLevels;
+            mips.maxLevels = std::min(LevelLimit(mips.maxLevels, size, size), paddedLevels);
+
+            const size_t maxLayers = static_cast<size_t>(Texture2DArray::MaxLayers());
+            std::vector<uint32_t> arrayOfLayer(layers.size());
+            std::vector<uint32_t> layerInArray(layers.size());
+            for (size_t first = 0; first < layers.size(); first += maxLayers) {
+                const size_t count = std::min(maxLayers, layers.size() - first);
+                auto array = std::make_unique<Texture2DArray>();
+                array->allocateStorage(size, size, static_cast<int>(count), InternalFormatFor(4, mips.srgb), mips.maxLevels);
+                Renderer::GL::TextureParams params;
+                params.wrapS = params.wrapT = GL_CLAMP_TO_EDGE;
+                array->setTextureParams(params);
+
+                for (size_t layer = 0; layer < count; ++layer) {
+                    m_Stats.gpuBytes += UploadLayer(*array, static_cast<int>(layer), layers[first + layer].data(), size, size, 4, mips);
+                    std::vector<uint8_t>().swap(layers[first + layer]);
+                    arrayOfLayer[first + layer] = static_cast<uint32_t>(m_Arrays.size());
+                    layerInArray[first + layer] = static_cast<uint32_t>(layer);
+                }
+                ++m_Stats.arrays;
+                m_Arrays.push_back(std::move(array));
+            }
+
+            const float texel = 1.0f / float(size);
+            for (const Placement& placement : placements) {
+                const DecodedImage& image = placement.entry->image;
+                TextureRegion& region = m_Regions[placement.entry->region];
+                region.uvOffset[0] = float(placement.x + padding) * texel;
+                region.uvOffset[1] = float(placement.y + padding) * texel;
+                region.uvScale[0] = float(image.width) * texel;
+                region.uvScale[1] = float(image.height) * texel;
+                region.array = arrayOfLayer[placement.layer];
+                region.layer = layerInArray[placement.layer];
+                region.width = static_cast<uint32_t>(image.width);
+                region.height = static_cast<uint32_t>(image.height);
+                placement.entry->image.pixels.reset();
+            }
+
+            const size_t atlasTexels = size_t(size) * size_t(size) * (m_Stats.atlasLayers + layers.size());
+            const size_t previouslyCovered = size_t(double(m_Stats.atlasOccupancy) * double(size_t(size) * size_t(size) * m_Stats.atlasLayers) + 0.5);
+            m_Stats.atlasLayers += layers.size();
+            m_Stats.atlasImages += placements.size();
+            m_Stats.atlasOccupancy = float(double(previouslyCovered + coveredTexels) / double(atlasTexels));
+        }
+    }
+}
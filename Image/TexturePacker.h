@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../NyxAPI.h"
+#include "../Renderer/GL/Texture2DArray.h"
+#include "../ModelLoaders/ModelLoader.h"
+#include "ImageLoader.h"
+
+namespace Nyx {
+
+    namespace Image {
+        // Where a packed texture ended up. 32 bytes laid out like the std140 struct
+        //   struct Region { vec4 uv; uvec4 info; };   // uv = offset.xy, scale.zw; info = array, layer, size
+        // so getRegions() can be copied into a uniform or storage buffer as is.
+        struct NYX_API TextureRegion {
+            float uvOffset[2] = { 0.0f, 0.0f };
+            float uvScale[2] = { 1.0f, 1.0f };  // sample at uv * uvScale + uvOffset
+            uint32_t array = 0;                 // Index for getArray()
+            uint32_t layer = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+
+            inline bool isValid() const { return width != 0; }
+        };
+
+        struct NYX_API TexturePackerConfig {
+            int atlasSize = 2048;         // Width and height of each atlas layer
+            int atlasMaxSize = 256;       // Images with both sides up to this size are packed into atlases
+            int padding = 4;              // Texels of edge extrusion around each atlas entry
+            bool flip = true;
+            MipBuildOptions mips;         // Atlas layers get at most 1 + log2(padding) levels, see build().
+                                          // mips.srgb is ignored: each file's colour space comes from addFile()
+        };
+
+        struct NYX_API TexturePackerStats {
+            size_t images = 0;
+            size_t failed = 0;
+            size_t arrays = 0;            // Texture2DArrays created, atlases included
+            size_t arrayLayers = 0;       // Layers holding one whole image
+            size_t atlasLayers = 0;
+            size_t atlasImages = 0;
+            float atlasOccupancy = 0.0f;  // Texels covered by images (padding excluded) / atlas texels
+            size_t gpuBytes = 0;          // Level 0 .. n of every array
+            double decodeMs = 0.0;
+            double packMs = 0.0;          // Packing, mip building and upload
+        };
+
+        // Region indices of one Material's textures, kNoRegion where it has none
+        struct NYX_API MaterialRegions {
+            static constexpr uint32_t kNoRegion = UINT32_MAX;
+            uint32_t diffuse = kNoRegion;
+            uint32_t specular = kNoRegion;
+            uint32_t normal = kNoRegion;
+        };
+
+        /**
+         * Packs many textures into a few GL_TEXTURE_2D_ARRAY bindings so draws with different materials
+         * can share a texture set (and with RenderQueue's auto-instancing, a single draw call):
+         *
+         * - Images of the same size, channel count and colour space become layers of one Texture2DArray.
+         * - Small images are rectangle-packed (skyline, bottom-left) into RGBA atlas layers with
+         *   padding, and get a UV offset and scale. sRGB and linear images never share an atlas.
+         *
+         * sRGB images get GL_SRGB8(_ALPHA8) storage and mips filtered in linear light; linear images
+         * (normal, specular, roughness maps) are stored and filtered as they are.
+         *
+         *   TexturePacker packer;
+         *   std::vector<MaterialRegions> regions = packer.addMaterials(model.GetMaterials(), "assets/");
+         *   packer.build();
+         *   item.textures[0] = packer.getArray(packer.getRegion(regions[m].diffuse).array);
+         *   item.material = regions[m].diffuse;   // looked up in getRegions() by the shader
+         *
+         * Atlas entries only support UVs within [0, 1]; textures that repeat must stay above
+         * atlasMaxSize or be loaded as standalone textures.
+         */
+        class NYX_API TexturePacker {
+        public:
+            TexturePacker(const TexturePackerConfig& config = {});
+            TexturePacker(const TexturePacker&) = delete;
+            TexturePacker& operator=(const TexturePacker&) = delete;
+
+            // Queues a file and returns its region index. Pass srgb for colour (albedo) textures.
+            // Adding a path twice with the same srgb returns the same index.
+            uint32_t addFile(const std::string& path, bool srgb = false);
+            // Queues every texture of the materials, paths relative to directory. Only diffuse maps are sRGB.
+            std::vector<MaterialRegions> addMaterials(const std::vector<Material>& materials, const std::string& directory);
+
+            // Decodes every queued file in parallel, packs, builds mips and uploads (GL thread).
+            // Can be called again after adding more files; only the new files are packed into new arrays.
+            bool build();
+
+            inline const TextureRegion& getRegion(uint32_t index) const { return m_Regions[index]; }
+            inline const std::vector<TextureRegion>& getRegions() const { return m_Regions; }
+            inline Renderer::GL::Texture2DArray* getArray(uint32_t index) const { return m_Arrays[index].get(); }
+            inline size_t getArrayCount() const { return m_Arrays.size(); }
+            inline const TexturePackerStats& getStats() const { return m_Stats; }
+
+        private:
+            struct PendingImage {
+                uint32_t region;
+                bool srgb;
+                DecodedImage image;
+            };
+
+            void buildArrays(std::vector<PendingImage*>& images);
+            void buildAtlases(std::vector<PendingImage*>& images, bool srgb);
+
+        private:
+            TexturePackerConfig m_Config;
+            std::vector<std::string> m_Paths;                 // Indexed by region
+            std::vector<uint8_t> m_Srgb;                      // Indexed by region
+            std::unordered_map<std::string, uint32_t> m_PathIndices[2];  // [srgb]
+            size_t m_Built = 0;                               // Regions already packed
+
+            std::vector<TextureRegion> m_Regions;
+            std::vector<std::unique_ptr<Renderer::GL::Texture2DArray>> m_Arrays;
+            TexturePackerStats m_Stats;
+        };
+    }
+}
@@ -0,0 +1,168 @@
+#include "AsyncModelLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+
+namespace Nyx
+{
+    AsyncModelLoader::AsyncModelLoader(Core::ThreadPool& pool)
+        : m_Pool(pool), m_Queue(std::make_shared<UploadQueue>())
+    {}
+
+    ModelHandle AsyncModelLoader::load(const std::string& path, const ModelConfig& config)
+    {
+        ModelHandle handle = std::make_shared<AsyncModel>();
+        std::shared_ptr<UploadQueue> queue = m_Queue;
+        queue->loadsInFlight.fetch_add(1);
+
+        handle->m_Model = m_Pool.submit([handle, queue, path, config]() -> std::shared_ptr<Model> {
+            std::shared_ptr<Model> model;
+            try
+            {
+                model = std::make_shared<Model>(path, config);
+                std::deque<UploadJob> jobs;
+                for (size_t i = 0; i < model->GetMeshes().size(); ++i)
+                {
+                    UploadJob job;
+                    job.handle = handle;
+                    job.model = model;
+                    job.meshIndex = i;
+                    jobs.push_back(std::move(job));
+                }
+
+                if (!jobs.empty())
+                {
+                    handle->m_State.store(ModelLoadState::Uploading);
+                    // Inserting at the end either adds every job or, when allocation fails, none of them
+                    std::lock_guard<std::mutex> lock(queue->mutex);
+                    queue->jobs.insert(queue->jobs.end(), std::make_move_iterator(jobs.begin()),
+                                       std::make_move_iterator(jobs.end()));
+                }
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "ERROR::MODEL::Failed to load " << path << ": " << e.what() << std::endl;
+                model.reset();
+            }
+            catch (...)
+            {
+                std::cerr << "ERROR::MODEL::Failed to load " << path << std::endl;
+                model.reset();
+            }
+
+            // Every exit has to leave loadsInFlight, or hasPendingUploads() would never settle
+            if (!model || model->GetMeshes().empty())
+            {
+                handle->m_State.store(ModelLoadState::Failed);
+                model.reset();
+            }
+            queue->loadsInFlight.fetch_sub(1);
+            return model;
+        }).share();
+
+        return handle;
+    }
+
+    bool AsyncModelLoader::hasPendingUploads() const
+    {
+        if (!m_Active.empty() || m_Queue->loadsInFlight.load() > 0)
+            return true;
+        std::lock_guard<std::mutex> lock(m_Queue->mutex);
+        return !m_Queue->jobs.empty();
+    }
+
+    size_t AsyncModelLoader::processUploads(const UploadBudget& budget)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Queue->mutex);
+            while (!m_Queue->jobs.empty())
+            {
+                m_Active.push_back(std::move(m_Queue->jobs.front()));
+                m_Queue->jobs.pop_front();
+            }
+        }
+
+        if (m_Active.empty())
+            return 0;
+
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        size_t uploaded = 0;
+
+        while (!m_Active.empty())
+        {
+            size_t remaining = budget.maxBytes > uploaded ? budget.maxBytes - uploaded : 0;
+            if (uploaded > 0 && remaining == 0)
+                break;
+
+            UploadJob& job = m_Active.front();
+            uploaded += uploadChunk(job, std::max<size_t>(remaining, 1));
+
+            if (job.gpu.vao)
+            {
+                AsyncModel& target = *job.handle;
+                target.m_VAOs.push_back(job.gpu.vao);
+                target.m_GPUMeshes.push_back(std::move(job.gpu));
+                if (target.m_GPUMeshes.size() == job.model->GetMeshes().size())
+                    target.m_State.store(ModelLoadState::Ready);
+                m_Active.pop_front();
+            }
+
+            double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (elapsedMs >= budget.maxMilliseconds)
+                break;
+        }
+        return uploaded;
+    }
+
+    size_t AsyncModelLoader::uploadChunk(UploadJob& job, size_t byteLimit)
+    {
+        const Mesh& mesh = job.model->GetMeshes()[job.meshIndex];
+        const size_t vertexBytes = mesh.vertices.size() * sizeof(Vertex);
+        const size_t indexBytes = mesh.indices.size() * sizeof(unsigned int);
+        size_t uploaded = 0;
+
+        // Buffers are allocated up front and filled with glBufferSubData so a large mesh
+        // can be spread over several frames.
+        if (!job.gpu.vbo)
+        {
+            job.gpu.vbo = std::make_unique<Renderer::GL::VBO>();
+            job.gpu.vbo->data(nullptr, vertexBytes, GL_STATIC_DRAW);
+            job.gpu.ibo = std::make_unique<Renderer::GL::IBO>();
+            job.gpu.ibo->data(nullptr, indexBytes, sizeof(unsigned int), GL_STATIC_DRAW);
+        }
+
+        if (job.vertexBytesDone < vertexBytes)
+        {
+            size_t chunk = std::min(byteLimit, vertexBytes - job.vertexBytesDone);
+            const char* src = reinterpret_cast<const char*>(mesh.vertices.data()) + job.vertexBytesDone;
+            job.gpu.vbo->subData(job.vertexBytesDone, src, chunk);
+            job.vertexBytesDone += chunk;
+            uploaded += chunk;
+            byteLimit -= chunk;
+        }
+
+        if (job.vertexBytesDone == vertexBytes && job.indexBytesDone < indexBytes && byteLimit > 0)
+        {
+            size_t chunk = std::min(byteLimit, indexBytes - job.indexBytesDone);
+            chunk -= chunk % sizeof(unsigned int);
+            if (chunk == 0)
+                chunk = std::min(sizeof(unsigned int), indexBytes - job.indexBytesDone);
+            const char* src = reinterpret_cast<const char*>(mesh.indices.data()) + job.indexBytesDone;
+            job.gpu.ibo->subData(job.indexBytesDone, src, chunk);
+            job.indexBytesDone += chunk;
+            uploaded += chunk;
+        }
+
+        if (job.vertexBytesDone == vertexBytes && job.indexBytesDone == indexBytes)
+        {
+            job.gpu.vao = std::make_shared<Renderer::GL::VAO>(mesh.indices.size());
+            job.gpu.vao->addVBO(job.gpu.vbo.get());
+            job.gpu.vao->attachIndexBuffer(job.gpu.ibo.get());
+            job.gpu.vao->setLayout(Model::GetVertexLayout());
+            job.gpu.vao->setBounds(mesh.bounds);
+        }
+        return uploaded;
+    }
+}
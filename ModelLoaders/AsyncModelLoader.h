@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../Core/ThreadPool.h"
+#include "ModelLoader.h"
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Nyx
+{
+    // Limits how much GPU upload work processUploads() does in one call.
+    // At least one chunk is always uploaded so loading keeps making progress.
+    struct NYX_API UploadBudget
+    {
+        double maxMilliseconds = 2.0;
+        size_t maxBytes = 8 * 1024 * 1024;
+    };
+
+    // GL objects created for one uploaded Mesh. The VAO references the VBO/IBO, so they live together.
+    struct NYX_API GPUMesh
+    {
+        std::unique_ptr<Renderer::GL::VBO> vbo;
+        std::unique_ptr<Renderer::GL::IBO> ibo;
+        std::shared_ptr<Renderer::GL::VAO> vao;
+    };
+
+    enum class ModelLoadState
+    {
+        Loading,    // Import and conversion are running on a worker thread
+        Uploading,  // CPU data is ready, meshes are being uploaded by processUploads()
+        Ready,
+        Failed
+    };
+
+    class NYX_API AsyncModel
+    {
+    public:
+        inline ModelLoadState getState() const { return m_State.load(); }
+        inline bool isReady() const { return m_State.load() == ModelLoadState::Ready; }
+
+        // Blocks until import and conversion have finished. Returns nullptr when loading failed.
+        std::shared_ptr<Model> waitForModel() const { return m_Model.get(); }
+        const std::shared_future<std::shared_ptr<Model>>& getFuture() const { return m_Model; }
+
+        // GL thread only. Meshes appear here in mesh order as they finish uploading,
+        // so a partially streamed model can already be drawn.
+        const std::vector<GPUMesh>& getGPUMeshes() const { return m_GPUMeshes; }
+        const std::vector<std::shared_ptr<Renderer::GL::VAO>>& getVAOs() const { return m_VAOs; }
+
+    private:
+        friend class AsyncModelLoader;
+
+        std::atomic<ModelLoadState> m_State{ ModelLoadState::Loading };
+        std::shared_future<std::shared_ptr<Model>> m_Model;
+        std::vector<GPUMesh> m_GPUMeshes;
+        std::vector<std::shared_ptr<Renderer::GL::VAO>> m_VAOs;
+    };
+
+    using ModelHandle = std::shared_ptr<AsyncModel>;
+
+    /**
+     * Loads models on background threads and uploads them to the GPU incrementally.
+     *
+     * Example:
+     *     Nyx::AsyncModelLoader loader;
+     *     Nyx::ModelHandle level = loader.load("assets/level.fbx");
+     *     while (!window.windowClosed()) {
+     *         loader.processUploads({ 2.0, 16 * 1024 * 1024 }); // GL thread
+     *         renderer.draw(level->getVAOs().data(), level->getVAOs().size());
+     *         window.update();
+     *     }
+     */
+    class NYX_API AsyncModelLoader
+    {
+    public:
+        AsyncModelLoader(Core::ThreadPool& pool = Core::ThreadPool::GetShared());
+
+        ModelHandle load(const std::string& path, const ModelConfig& config = {});
+
+        // Must be called on the thread that owns the GL context. Returns the number of bytes uploaded.
+        size_t processUploads(const UploadBudget& budget = {});
+        // True while any model is still importing or has meshes left to upload.
+        bool hasPendingUploads() const;
+
+    private:
+        struct UploadJob
+        {
+            ModelHandle handle;
+            std::shared_ptr<Model> model;
+            size_t meshIndex = 0;
+            size_t vertexBytesDone = 0;
+            size_t indexBytesDone = 0;
+            GPUMesh gpu;
+        };
+
+        // Shared with worker tasks so the loader can be destroyed while imports are still running.
+        struct UploadQueue
+        {
+            std::mutex mutex;
+            std::deque<UploadJob> jobs;
+            std::atomic<size_t> loadsInFlight{ 0 };
+        };
+
+        size_t uploadChunk(UploadJob& job, size_t byteLimit);
+
+    private:
+        Core::ThreadPool& m_Pool;
+        std::shared_ptr<UploadQueue> m_Queue;
+        std::deque<UploadJob> m_Active; // GL thread only
+    };
+}
@@ -0,0 +1,87 @@
+#include "MappedIOSystem.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace Nyx
+{
+    MappedIOStream::MappedIOStream(IO::MappedFile&& file)
+        : m_File(std::move(file))
+    {}
+
+    size_t MappedIOStream::Read(void* buffer, size_t size, size_t count)
+    {
+        if (size == 0 || m_Position >= m_File.size())
+            return 0;
+
+        // Whole elements only, like fread
+        const size_t elements = std::min(count, (m_File.size() - m_Position) / size);
+        std::memcpy(buffer, m_File.data() + m_Position, elements * size);
+        m_Position += elements * size;
+
+        // A seek back refaults released pages from the file, so this only costs time, never data
+        if (m_Position >= m_Released + kReleaseWindow)
+        {
+            m_File.advise(IO::AccessPattern::DontNeed, m_Released, m_Position - m_Released);
+            m_Released = m_Position;
+        }
+        return elements;
+    }
+
+    size_t MappedIOStream::Write(const void*, size_t, size_t)
+    {
+        return 0;
+    }
+
+    aiReturn MappedIOStream::Seek(size_t offset, aiOrigin origin)
+    {
+        size_t position;
+        switch (origin)
+        {
+        case aiOrigin_SET: position = offset; break;
+        case aiOrigin_CUR: position = m_Position + offset; break;
+        case aiOrigin_END: position = m_File.size() - offset; break;
+        default: return AI_FAILURE;
+        }
+        if (offset > m_File.size() || position > m_File.size())
+            return AI_FAILURE;
+
+        m_Position = position;
+        m_Released = std::min(m_Released, position);
+        return AI_SUCCESS;
+    }
+
+    bool MappedIOSystem::Exists(const char* path) const
+    {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(path, ec);
+    }
+
+    char MappedIOSystem::getOsSeparator() const
+    {
+#ifdef _WIN32
+        return '\\';
+#else
+        return '/';
+#endif
+    }
+
+    Assimp::IOStream* MappedIOSystem::Open(const char* path, const char* mode)
+    {
+        if (std::strchr(mode, 'w') || std::strchr(mode, 'a') || std::strchr(mode, '+'))
+            return nullptr;
+
+        IO::MappedFile file;
+        if (!file.open(path, IO::AccessPattern::Sequential))
+            return nullptr;
+        if (std::find(m_OpenedFiles.begin(), m_OpenedFiles.end(), path) == m_OpenedFiles.end())
+            m_OpenedFiles.emplace_back(path);
+        return new MappedIOStream(std::move(file));
+    }
+
+    void MappedIOSystem::Close(Assimp::IOStream* stream)
+    {
+        delete stream;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../IO/MappedFile.h"
+#include "../vendor/assimp/IOStream.hpp"
+#include "../vendor/assimp/IOSystem.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Nyx
+{
+    // Assimp stream over a memory-mapped file. Read() copies straight out of the mapping, and pages
+    // the importer has moved past are released in windows of kReleaseWindow so a large model is
+    // not held in memory twice.
+    class NYX_API MappedIOStream : public Assimp::IOStream
+    {
+    public:
+        static constexpr size_t kReleaseWindow = 4 * 1024 * 1024;
+
+        explicit MappedIOStream(IO::MappedFile&& file);
+
+        size_t Read(void* buffer, size_t size, size_t count) override;
+        size_t Write(const void* buffer, size_t size, size_t count) override;
+        aiReturn Seek(size_t offset, aiOrigin origin) override;
+        size_t Tell() const override { return m_Position; }
+        size_t FileSize() const override { return m_File.size(); }
+        void Flush() override {}
+
+    private:
+        IO::MappedFile m_File;
+        size_t m_Position = 0;
+        size_t m_Released = 0;  // Bytes before this were handed back with AccessPattern::DontNeed
+    };
+
+    // Read-only Assimp IOSystem that serves every file the importer opens (the model and anything it
+    // references, e.g. .mtl or .bin files) from a mapping with a sequential read-ahead hint.
+    // Write modes are refused; importers never write.
+    class NYX_API MappedIOSystem : public Assimp::IOSystem
+    {
+    public:
+        bool Exists(const char* path) const override;
+        char getOsSeparator() const override;
+        Assimp::IOStream* Open(const char* path, const char* mode = "rb") override;
+        void Close(Assimp::IOStream* stream) override;
+
+        // Every file opened successfully so far, in first-open order without repeats. MeshCache records
+        // them so an edited .mtl, .bin or other referenced file invalidates the cache.
+        inline const std::vector<std::string>& getOpenedFiles() const { return m_OpenedFiles; }
+
+    private:
+        std::vector<std::string> m_OpenedFiles;
+    };
+}
@@ -0,0 +1,317 @@
+#include "MeshCache.h"
+#include "../Core/Hash.h"
+#include "../IO/MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace Nyx
+{
+    namespace
+    {
+        constexpr uint32_t kMagic = 0x4D58594E; // "NYXM"
+
+        struct CacheHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t key;
+            uint32_t vertexSize;
+            uint32_t meshCount;
+            uint32_t materialCount;
+            uint32_t dependencyCount;   // Path, size and mtime of each, right after the header
+            uint64_t vertexCount;   // Sum over all meshes, sizes the MeshArena
+            uint64_t indexCount;
+        };
+
+        // Bounds-checked cursor over the mapped cache file.
+        struct Reader
+        {
+            const unsigned char* data;
+            size_t size;
+            size_t offset = 0;
+
+            bool read(void* out, size_t bytes)
+            {
+                if (bytes > size - offset)
+                    return false;
+                std::memcpy(out, data + offset, bytes);
+                offset += bytes;
+                return true;
+            }
+            template<typename T>
+            bool read(T& out) { return read(&out, sizeof(T)); }
+
+            // Guards resize() against corrupt counts before any data is read
+            bool has(uint64_t count, size_t elementSize) const
+            {
+                return count <= (size - offset) / elementSize;
+            }
+
+            bool readString(std::string& out)
+            {
+                uint32_t length;
+                if (!read(length) || length > size - offset)
+                    return false;
+                out.assign(reinterpret_cast<const char*>(data + offset), length);
+                offset += length;
+                return true;
+            }
+        };
+
+        struct FileStamp
+        {
+            uint64_t size = 0;
+            int64_t mtime = 0;   // file_time_type ticks, only ever compared with the same clock
+        };
+
+        bool GetFileStamp(const std::string& path, FileStamp& stamp)
+        {
+            std::error_code ec;
+            const uintmax_t size = std::filesystem::file_size(path, ec);
+            if (ec)
+                return false;
+            const auto mtime = std::filesystem::last_write_time(path, ec);
+            if (ec)
+                return false;
+            stamp.size = static_cast<uint64_t>(size);
+            stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+            return true;
+        }
+
+        struct Writer
+        {
+            std::string buffer;
+
+            void write(const void* in, size_t bytes)
+            {
+                buffer.append(static_cast<const char*>(in), bytes);
+            }
+            template<typename T>
+            void write(const T& in) { write(&in, sizeof(T)); }
+
+            void writeString(const std::string& str)
+            {
+                write(static_cast<uint32_t>(str.size()));
+                write(str.data(), str.size());
+            }
+        };
+    }
+
+    uint64_t MeshCache::ComputeKey(const void* sourceData, size_t sourceSize, uint64_t optionsKey)
+    {
+        uint64_t key = Core::HashBytes(sourceData, sourceSize);
+        key = Core::HashCombine(key, sourceSize);
+        key = Core::HashCombine(key, optionsKey);
+        key = Core::HashCombine(key, kVersion);
+        return key;
+    }
+
+    std::string MeshCache::GetCachePath(const std::string& sourcePath, const std::string& cacheDirectory)
+    {
+        if (cacheDirectory.empty())
+            return sourcePath + ".nyxmesh";
+
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(sourcePath, ec);
+        if (ec)
+            canonical = std::filesystem::absolute(sourcePath, ec).lexically_normal();
+
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".%016llx.nyxmesh",
+                      static_cast<unsigned long long>(Core::HashString(canonical.generic_string())));
+        std::filesystem::path fileName = std::filesystem::path(sourcePath).filename();
+        return (std::filesystem::path(cacheDirectory) / fileName).string() + suffix;
+    }
+
+    bool MeshCache::Load(const std::string& cachePath, uint64_t key,
+                         std::vector<Mesh>& meshes, std::vector<Material>& materials, MeshArena& arena)
+    {
+        IO::MappedFile file;
+        if (!file.open(cachePath, IO::AccessPattern::Sequential) || file.size() == 0)
+            return false;
+
+        Reader reader{ file.data(), file.size() };
+
+        CacheHeader header;
+        if (!reader.read(header) ||
+            header.magic != kMagic ||
+            header.version != kVersion ||
+            header.key != key ||
+            header.vertexSize != sizeof(Vertex) ||
+            !reader.has(header.materialCount, sizeof(uint32_t)) ||
+            !reader.has(header.meshCount, sizeof(uint32_t) * 3) ||
+            !reader.has(header.vertexCount, sizeof(Vertex)) ||
+            !reader.has(header.indexCount, sizeof(unsigned int)) ||
+            !reader.has(header.dependencyCount, sizeof(uint32_t) + sizeof(FileStamp)))
+            return false;
+
+        // A referenced file that changed or disappeared makes the whole cache stale
+        for (uint32_t i = 0; i < header.dependencyCount; ++i)
+        {
+            std::string path;
+            FileStamp recorded, current;
+            if (!reader.readString(path) || !reader.read(recorded.size) || !reader.read(recorded.mtime) ||
+                !GetFileStamp(path, current) || current.size != recorded.size || current.mtime != recorded.mtime)
+                return false;
+        }
+
+        std::vector<Material> loadedMaterials(header.materialCount);
+        for (Material& material : loadedMaterials)
+        {
+            if (!reader.readString(material.name) ||
+                !reader.read(material.diffuse) ||
+                !reader.read(material.specular) ||
+                !reader.read(material.ambient) ||
+                !reader.readString(material.diffuseTex) ||
+                !reader.readString(material.specularTex) ||
+                !reader.readString(material.normalTex))
+                return false;
+        }
+
+        MeshArena loadedArena;
+        loadedArena.allocate(header.vertexCount, header.indexCount);
+        size_t firstVertex = 0, firstIndex = 0;
+
+        std::vector<Mesh> loadedMeshes(header.meshCount);
+        for (Mesh& mesh : loadedMeshes)
+        {
+            uint32_t vertexCount, indexCount;
+            if (!reader.read(mesh.materialIndex) ||
+                !reader.read(mesh.bounds) ||
+                !reader.read(vertexCount) ||
+                !reader.read(indexCount) ||
+                vertexCount > header.vertexCount - firstVertex ||
+                indexCount > header.indexCount - firstIndex)
+                return false;
+
+            mesh.vertices = loadedArena.vertexRange(firstVertex, vertexCount);
+            mesh.indices = loadedArena.indexRange(firstIndex, indexCount);
+            firstVertex += vertexCount;
+            firstIndex += indexCount;
+            if (!reader.read(mesh.vertices.data(), vertexCount * sizeof(Vertex)) ||
+                !reader.read(mesh.indices.data(), indexCount * sizeof(unsigned int)))
+                return false;
+
+            uint32_t lodCount;
+            if (!reader.read(lodCount) || !reader.has(lodCount, sizeof(float) + sizeof(uint32_t)))
+                return false;
+            mesh.lods.resize(lodCount);
+            for (MeshLOD& lod : mesh.lods)
+            {
+                uint32_t lodIndexCount;
+                if (!reader.read(lod.error) || !reader.read(lodIndexCount) ||
+                    !reader.has(lodIndexCount, sizeof(unsigned int)))
+                    return false;
+                lod.indices.resize(lodIndexCount);
+                if (!reader.read(lod.indices.data(), lodIndexCount * sizeof(unsigned int)))
+                    return false;
+            }
+        }
+
+        if (firstVertex != header.vertexCount || firstIndex != header.indexCount)
+            return false;
+
+        meshes = std::move(loadedMeshes);
+        materials = std::move(loadedMaterials);
+        arena = std::move(loadedArena);
+        return true;
+    }
+
+    bool MeshCache::Save(const std::string& cachePath, uint64_t key,
+                         const std::vector<Mesh>& meshes, const std::vector<Material>& materials,
+                         const std::vector<std::string>& dependencies)
+    {
+        Writer writer;
+
+        CacheHeader header = {};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.key = key;
+        header.vertexSize = sizeof(Vertex);
+        header.meshCount = static_cast<uint32_t>(meshes.size());
+        header.materialCount = static_cast<uint32_t>(materials.size());
+        header.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        for (const Mesh& mesh : meshes)
+        {
+            header.vertexCount += mesh.vertices.size();
+            header.indexCount += mesh.indices.size();
+        }
+        writer.write(header);
+
+        for (const std::string& dependency : dependencies)
+        {
+            // Stamped after the import read it; a file edited in between is caught on the next import
+            FileStamp stamp;
+            if (!GetFileStamp(dependency, stamp))
+            {
+                std::cerr << "Failed to write mesh cache: cannot stat " << dependency << "\n";
+                return false;
+            }
+            writer.writeString(dependency);
+            writer.write(stamp.size);
+            writer.write(stamp.mtime);
+        }
+
+        for (const Material& material : materials)
+        {
+            writer.writeString(material.name);
+            writer.write(material.diffuse);
+            writer.write(material.specular);
+            writer.write(material.ambient);
+            writer.writeString(material.diffuseTex);
+            writer.writeString(material.specularTex);
+            writer.writeString(material.normalTex);
+        }
+
+        for (const Mesh& mesh : meshes)
+        {
+            writer.write(mesh.materialIndex);
+            writer.write(mesh.bounds);
+            writer.write(static_cast<uint32_t>(mesh.vertices.size()));
+            writer.write(static_cast<uint32_t>(mesh.indices.size()));
+            writer.write(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+            writer.write(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+
+            writer.write(static_cast<uint32_t>(mesh.lods.size()));
+            for (const MeshLOD& lod : mesh.lods)
+            {
+                writer.write(lod.error);
+                writer.write(static_cast<uint32_t>(lod.indices.size()));
+                writer.write(lod.indices.data(), lod.indices.size() * sizeof(unsigned int));
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::path target(cachePath);
+        if (target.has_parent_path())
+            std::filesystem::create_directories(target.parent_path(), ec);
+
+        std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out)
+            {
+                std::cerr << "Failed to write mesh cache: " << tempPath << "\n";
+                return false;
+            }
+            out.write(writer.buffer.data(), static_cast<std::streamsize>(writer.buffer.size()));
+            if (!out)
+            {
+                std::cerr << "Failed to write mesh cache: " << tempPath << "\n";
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, target, ec);
+        if (ec)
+        {
+            std::cerr << "Failed to write mesh cache: " << cachePath << " (" << ec.message() << ")\n";
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "ModelLoader.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Nyx
+{
+    // Versioned binary cache of post-processed Mesh/Material data.
+    // A cache file is only accepted when its key matches the hash of the source file and import options,
+    // and every file the import read besides it (.mtl, .bin, ...) still has its recorded size and
+    // modification time, so editing an asset or changing import flags transparently falls back to a full import.
+    class NYX_API MeshCache
+    {
+    public:
+        // Bump whenever the on-disk layout or the meaning of cached data changes.
+        static constexpr uint32_t kVersion = 5;
+
+        static uint64_t ComputeKey(const void* sourceData, size_t sourceSize, uint64_t optionsKey);
+        // "<file>.<hash>.nyxmesh" in cacheDirectory, the hash covering the canonical source path so that
+        // same-named models from different folders never share a file. An empty cacheDirectory stores
+        // "<source>.nyxmesh" next to the source.
+        static std::string GetCachePath(const std::string& sourcePath, const std::string& cacheDirectory);
+
+        // Reads the cache through a memory mapping into a freshly allocated arena that the meshes point
+        // into. Returns false on a missing, stale or corrupt file, leaving the outputs untouched.
+        static bool Load(const std::string& cachePath, uint64_t key,
+                         std::vector<Mesh>& meshes, std::vector<Material>& materials, MeshArena& arena);
+        // Writes to a temporary file first so a crash never leaves a truncated cache behind.
+        // dependencies are the files referenced by the source, stamped with their current size and mtime.
+        static bool Save(const std::string& cachePath, uint64_t key,
+                         const std::vector<Mesh>& meshes, const std::vector<Material>& materials,
+                         const std::vector<std::string>& dependencies = {});
+    };
+}
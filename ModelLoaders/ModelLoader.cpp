@@ -1,67 +1,232 @@
 #include "ModelLoader.h"
+#include "MeshCache.h"
+#include "MappedIOSystem.h"
+#include "VertexFormat.h"
+#include "../Geometry/Simplifier.h"
+#include "../Geometry/IndexOptimizer.h"
+#include "../Core/Hash.h"
+#include "../IO/MappedFile.h"
+#include "../Core/ThreadPool.h"
+#include "../Renderer/GL/StateCache.h"
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 namespace Nyx
 {
-    Model::Model(const std::string& path)
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double ElapsedMs(Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        Geometry::Bounds ComputeMeshBounds(const Mesh& mesh)
+        {
+            if (mesh.vertices.empty())
+                return {};
+            return Geometry::ComputeBounds(mesh.vertices[0].Position, mesh.vertices.size(), sizeof(Vertex));
+        }
+    }
+
+    void MeshArena::allocate(size_t newVertexCount, size_t newIndexCount)
+    {
+        // Plain new[] default-initializes: every element is written by the loader, so skip zeroing
+        vertices.reset(new Vertex[newVertexCount]);
+        indices.reset(new unsigned int[newIndexCount]);
+        vertexCount = newVertexCount;
+        indexCount = newIndexCount;
+    }
+
+    Model::Model(const std::string& path, const ModelConfig& config)
+        : m_Config(config)
     {
         LoadModel(path);
     }
 
     void Model::LoadModel(const std::string& path)
     {
+        auto totalStart = Clock::now();
+        m_Directory = path.substr(0, path.find_last_of('/'));
+
+        if (!m_Config.useMeshCache)
+        {
+            ImportScene(path);
+            m_LoadStats.totalMs = ElapsedMs(totalStart);
+            return;
+        }
+
+        auto cacheStart = Clock::now();
+        IO::MappedFile source;
+        if (!source.open(path))
+        {
+            std::cerr << "ERROR::MODEL::Failed to open: " << path << std::endl;
+            return;
+        }
+
+        uint64_t key = MeshCache::ComputeKey(source.data(), source.size(), ComputeOptionsKey(m_Config));
+        std::string cachePath = MeshCache::GetCachePath(path, m_Config.cacheDirectory);
+        source.close();
+
+        if (MeshCache::Load(cachePath, key, m_Meshes, m_Materials, m_Arena))
+        {
+            m_LoadStats.cacheHit = true;
+            m_LoadStats.cacheMs = ElapsedMs(cacheStart);
+            m_LoadStats.totalMs = ElapsedMs(totalStart);
+            return;
+        }
+        m_LoadStats.cacheMs = ElapsedMs(cacheStart);
+
+        std::vector<std::string> dependencies;
+        if (ImportScene(path, &dependencies))
+        {
+            cacheStart = Clock::now();
+            MeshCache::Save(cachePath, key, m_Meshes, m_Materials, dependencies);
+            m_LoadStats.cacheMs += ElapsedMs(cacheStart);
+        }
+        m_LoadStats.totalMs = ElapsedMs(totalStart);
+    }
+
+    bool Model::ImportScene(const std::string& path, std::vector<std::string>* dependencies)
+    {
+        auto importStart = Clock::now();
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(path,
-            aiProcess_Triangulate |
-            aiProcess_GenSmoothNormals |
-            aiProcess_CalcTangentSpace |
-            aiProcess_JoinIdenticalVertices |
-            aiProcess_ImproveCacheLocality |
-            aiProcess_LimitBoneWeights);
+        MappedIOSystem* io = new MappedIOSystem();
+        importer.SetIOHandler(io); // The importer owns and deletes it
+        const aiScene* scene = importer.ReadFile(path, m_Config.importFlags);
+        m_LoadStats.importMs = ElapsedMs(importStart);
+
+        if (dependencies)
+        {
+            // The model file itself is covered by the cache key
+            std::error_code ec;
+            for (const std::string& opened : io->getOpenedFiles())
+                if (opened != path && !std::filesystem::equivalent(opened, path, ec))
+                    dependencies->push_back(opened);
+        }
 
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
             std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
-            return;
+            return false;
         }
 
-        m_Directory = path.substr(0, path.find_last_of('/'));
+        auto processStart = Clock::now();
 
-        // Load materials first
-        m_Materials.reserve(scene->mNumMaterials);
-        for (unsigned int i = 0; i < scene->mNumMaterials; ++i)
+        // Flatten the node tree so each mesh gets a fixed output slot in node order
+        std::vector<aiMesh*> sceneMeshes;
+        CollectMeshes(scene->mRootNode, scene, sceneMeshes);
+
+        m_Materials.resize(scene->mNumMaterials);
+        m_Meshes.resize(sceneMeshes.size());
+
+        // Size every mesh up front and carve all of them out of one vertex and one index allocation
+        std::vector<size_t> indexCounts(sceneMeshes.size(), 0);
+        size_t vertexTotal = 0, indexTotal = 0;
+        for (size_t i = 0; i < sceneMeshes.size(); ++i)
         {
-            m_Materials.push_back(ProcessMaterial(scene->mMaterials[i]));
+            const aiMesh* mesh = sceneMeshes[i];
+            for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+                indexCounts[i] += mesh->mFaces[f].mNumIndices;
+            vertexTotal += mesh->mNumVertices;
+            indexTotal += indexCounts[i];
+        }
+        m_Arena.allocate(vertexTotal, indexTotal);
+        for (size_t i = 0, firstVertex = 0, firstIndex = 0; i < sceneMeshes.size(); ++i)
+        {
+            m_Meshes[i].vertices = m_Arena.vertexRange(firstVertex, sceneMeshes[i]->mNumVertices);
+            m_Meshes[i].indices = m_Arena.indexRange(firstIndex, indexCounts[i]);
+            firstVertex += sceneMeshes[i]->mNumVertices;
+            firstIndex += indexCounts[i];
         }
 
-        // Process nodes & meshes
-        ProcessNode(scene->mRootNode, scene);
+        if (m_Config.parallelProcessing)
+        {
+            Core::ThreadPool& pool = Core::ThreadPool::GetShared();
+            pool.parallelFor(m_Materials.size(), [&](size_t i) {
+                m_Materials[i] = ProcessMaterial(scene->mMaterials[i]);
+            });
+            pool.parallelFor(m_Meshes.size(), [&](size_t i) {
+                ProcessMesh(sceneMeshes[i], m_Meshes[i]);
+            });
+        }
+        else
+        {
+            for (size_t i = 0; i < m_Materials.size(); ++i)
+                m_Materials[i] = ProcessMaterial(scene->mMaterials[i]);
+            for (size_t i = 0; i < m_Meshes.size(); ++i)
+                ProcessMesh(sceneMeshes[i], m_Meshes[i]);
+        }
+
+        // LODs first so the optimizer reorders them and the vertex fetch remap covers every level
+        auto finishMesh = [&](size_t i) {
+            if (m_Config.generateLODs)
+                m_Meshes[i].lods = Geometry::GenerateLODChain(m_Meshes[i], m_Config.lodConfig);
+            if (m_Config.optimizeMeshes)
+                Geometry::OptimizeMesh(m_Meshes[i], m_Config.optimizeConfig);
+            m_Meshes[i].bounds = ComputeMeshBounds(m_Meshes[i]);
+        };
+        if (m_Config.parallelProcessing)
+            Core::ThreadPool::GetShared().parallelFor(m_Meshes.size(), finishMesh);
+        else
+            for (size_t i = 0; i < m_Meshes.size(); ++i)
+                finishMesh(i);
+
+        m_LoadStats.processMs = ElapsedMs(processStart);
+        return true;
     }
 
-    void Model::ProcessNode(aiNode* node, const aiScene* scene)
+    uint64_t Model::ComputeOptionsKey(const ModelConfig& config)
+    {
+        // Everything that changes the processed output must be part of the cache key
+        uint64_t key = Core::HashCombine(Core::kFNVOffsetBasis, config.importFlags);
+        key = Core::HashCombine(key, config.generateLODs ? 1 : 0);
+        if (config.generateLODs)
+        {
+            const LODConfig& lod = config.lodConfig;
+            key = Core::HashCombine(key, lod.levelCount);
+            key = Core::HashBytes(&lod.reductionPerLevel, sizeof(float), key);
+            key = Core::HashBytes(&lod.maxError, sizeof(float), key);
+            key = Core::HashBytes(&lod.attributeWeight, sizeof(float), key);
+            key = Core::HashCombine(key, lod.lockBorder ? 1 : 0);
+        }
+        key = Core::HashCombine(key, config.optimizeMeshes ? 1 : 0);
+        if (config.optimizeMeshes)
+        {
+            const MeshOptimizeConfig& optimize = config.optimizeConfig;
+            key = Core::HashCombine(key, optimize.cacheSize);
+            key = Core::HashCombine(key, optimize.optimizeOverdraw ? 1 : 0);
+            key = Core::HashBytes(&optimize.overdrawThreshold, sizeof(float), key);
+            key = Core::HashCombine(key, optimize.optimizeVertexFetch ? 1 : 0);
+        }
+        return key;
+    }
+
+    void Model::CollectMeshes(aiNode* node, const aiScene* scene, std::vector<aiMesh*>& outMeshes) const
     {
         for (unsigned int i = 0; i < node->mNumMeshes; ++i)
         {
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-            m_Meshes.push_back(ProcessMesh(mesh, scene));
+            outMeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
         }
 
         for (unsigned int i = 0; i < node->mNumChildren; ++i)
         {
-            ProcessNode(node->mChildren[i], scene);
+            CollectMeshes(node->mChildren[i], scene, outMeshes);
         }
     }
 
-    Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* /*scene*/)
+    void Model::ProcessMesh(aiMesh* mesh, Mesh& outMesh) const
     {
-        Mesh outMesh;
-
         // Vertices
         for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
         {
-            Vertex vertex = {};
+            Vertex& vertex = outMesh.vertices[i];
+            vertex = {};
 
             if (mesh->HasPositions())
             {
@@ -93,25 +258,21 @@ namespace Nyx
                 vertex.Bitangent[1] = mesh->mBitangents[i].y;
                 vertex.Bitangent[2] = mesh->mBitangents[i].z;
             }
-
-            outMesh.vertices.push_back(vertex);
         }
 
         // Indices
+        unsigned int* out = outMesh.indices.data();
         for (unsigned int i = 0; i < mesh->mNumFaces; ++i)
         {
-            aiFace face = mesh->mFaces[i];
-            for (unsigned int j = 0; j < face.mNumIndices; ++j)
-                outMesh.indices.push_back(face.mIndices[j]);
+            const aiFace& face = mesh->mFaces[i];
+            out = std::copy(face.mIndices, face.mIndices + face.mNumIndices, out);
         }
 
         // Material index
         outMesh.materialIndex = mesh->mMaterialIndex;
-
-        return outMesh;
     }
 
-    Material Model::ProcessMaterial(aiMaterial* mat)
+    Material Model::ProcessMaterial(aiMaterial* mat) const
     {
         Material material;
 
@@ -143,6 +304,18 @@ namespace Nyx
 
         return material;
     }
+    std::vector<Renderer::GL::VertexAttribute> Model::GetVertexLayout()
+    {
+        GLsizei stride = sizeof(Vertex);
+        return {
+            { 0, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Position)   }, // Pos
+            { 1, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Normal)     }, // Normal
+            { 2, 2, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, TexCoords)  }, // UV
+            { 3, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Tangent)    }, // Tangent
+            { 4, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Bitangent)  }  // Bitangent
+        };
+    }
+
     void Model::LoadToVAO(
         size_t meshIndex,
         Nyx::Renderer::GL::VBO& vbo,
@@ -179,78 +352,190 @@ namespace Nyx
         vao->attachIndexBuffer(&ibo);
 
         vao->bind();
-        GLsizei stride = sizeof(Vertex);
-
-        vao->setLayout({
-            { 0, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Position)   }, // Pos
-            { 1, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Normal)     }, // Normal
-            { 2, 2, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, TexCoords)  }, // UV
-            { 3, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Tangent)    }, // Tangent
-            { 4, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Bitangent)  }  // Bitangent
-            });
+        vao->setLayout(GetVertexLayout());
+        vao->setBounds(mesh.bounds);
 
         vao->unbind();
     }
-    void Model::LoadAsComplete(
+    void Model::LoadToVAO(
+        size_t meshIndex,
+        const VertexFormat& format,
         Nyx::Renderer::GL::VBO& vbo,
         Nyx::Renderer::GL::IBO& ibo,
-        std::shared_ptr<Nyx::Renderer::GL::VAO>& vao
+        std::shared_ptr<Nyx::Renderer::GL::VAO>& vao,
+        VertexDequantization* outDequantization
     ) const
     {
-        if (m_Meshes.empty())
+        if (meshIndex >= m_Meshes.size())
         {
-            std::cerr << "No meshes to combine in model.\n";
+            std::cerr << "Invalid mesh index: " << meshIndex << std::endl;
             return;
         }
 
-        std::vector<Vertex> combinedVertices;
-        std::vector<unsigned int> combinedIndices;
+        const Mesh& mesh = m_Meshes[meshIndex];
+        EncodedVertices encoded = EncodeVertices(mesh, format);
+        if (outDequantization)
+            *outDequantization = encoded.dequantization;
 
-        size_t vertexOffset = 0;
-        for (const auto& mesh : m_Meshes)
+        // --- VBO ---
+        vbo.data(
+            encoded.data.data(),
+            encoded.data.size(),
+            GL_STATIC_DRAW
+        );
+
+        // --- IBO ---
+        ibo.data(
+            mesh.indices.data(),
+            mesh.indices.size() * sizeof(unsigned int),
+            sizeof(unsigned int),
+            GL_STATIC_DRAW
+        );
+
+        // --- VAO ---
+        vao = std::make_shared<Nyx::Renderer::GL::VAO>(mesh.indices.size());
+        vao->addVBO(&vbo);
+        vao->attachIndexBuffer(&ibo);
+
+        vao->bind();
+        vao->setLayout(encoded.layout);
+        vao->setBounds(mesh.bounds);
+        vao->unbind();
+    }
+    void Model::LoadLODsToVAO(
+        size_t meshIndex,
+        Nyx::Renderer::GL::VBO& vbo,
+        Nyx::Renderer::GL::IBO& ibo,
+        std::shared_ptr<Nyx::Renderer::GL::VAO>& vao,
+        std::vector<Geometry::IndexRange>& lodRanges
+    ) const
+    {
+        if (meshIndex >= m_Meshes.size())
         {
-            // append vertices
-            combinedVertices.insert(combinedVertices.end(),
-                mesh.vertices.begin(),
-                mesh.vertices.end());
+            std::cerr << "Invalid mesh index: " << meshIndex << std::endl;
+            return;
+        }
 
-            // append indices (offset them!)
-            for (unsigned int idx : mesh.indices)
-                combinedIndices.push_back(idx + static_cast<unsigned int>(vertexOffset));
+        const Mesh& mesh = m_Meshes[meshIndex];
+
+        size_t totalIndices = mesh.indices.size();
+        for (const MeshLOD& lod : mesh.lods)
+            totalIndices += lod.indices.size();
 
-            vertexOffset += mesh.vertices.size();
+        std::vector<unsigned int> allIndices;
+        allIndices.reserve(totalIndices);
+        lodRanges.clear();
+        lodRanges.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()) });
+        allIndices.insert(allIndices.end(), mesh.indices.begin(), mesh.indices.end());
+        for (const MeshLOD& lod : mesh.lods)
+        {
+            lodRanges.push_back({ static_cast<uint32_t>(allIndices.size()), static_cast<uint32_t>(lod.indices.size()) });
+            allIndices.insert(allIndices.end(), lod.indices.begin(), lod.indices.end());
         }
 
         // --- VBO ---
         vbo.data(
-            combinedVertices.data(),
-            combinedVertices.size() * sizeof(Vertex),
+            mesh.vertices.data(),
+            mesh.vertices.size() * sizeof(Vertex),
             GL_STATIC_DRAW
         );
 
         // --- IBO ---
         ibo.data(
-            combinedIndices.data(),
-            combinedIndices.size() * sizeof(unsigned int),
+            allIndices.data(),
+            allIndices.size() * sizeof(unsigned int),
             sizeof(unsigned int),
             GL_STATIC_DRAW
         );
 
         // --- VAO ---
-        vao = std::make_shared<Nyx::Renderer::GL::VAO>(combinedIndices.size());
+        vao = std::make_shared<Nyx::Renderer::GL::VAO>(mesh.indices.size());
         vao->addVBO(&vbo);
         vao->attachIndexBuffer(&ibo);
 
         vao->bind();
-        GLsizei stride = sizeof(Vertex);
+        vao->setLayout(GetVertexLayout());
+        vao->setBounds(mesh.bounds);
+        vao->unbind();
+    }
+    Renderer::GL::ArenaAllocation Model::LoadToArena(size_t meshIndex, Renderer::GL::GeometryArena& arena) const
+    {
+        if (meshIndex >= m_Meshes.size())
+        {
+            std::cerr << "Invalid mesh index: " << meshIndex << std::endl;
+            return {};
+        }
+        if (arena.getVertexStride() != sizeof(Vertex))
+        {
+            std::cerr << "Arena vertex stride " << arena.getVertexStride() << " does not match Nyx::Vertex\n";
+            return {};
+        }
 
-        vao->setLayout({
-            { 0, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Position)   },
-            { 1, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Normal)     },
-            { 2, 2, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, TexCoords)  },
-            { 3, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Tangent)    },
-            { 4, 3, GL_FLOAT, GL_FALSE, stride, offsetof(Vertex, Bitangent)  }
-            });
+        const Mesh& mesh = m_Meshes[meshIndex];
+        return arena.allocate(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size());
+    }
+    void Model::LoadAsComplete(
+        Nyx::Renderer::GL::VBO& vbo,
+        Nyx::Renderer::GL::IBO& ibo,
+        std::shared_ptr<Nyx::Renderer::GL::VAO>& vao
+    ) const
+    {
+        if (m_Meshes.empty())
+        {
+            std::cerr << "No meshes to combine in model.\n";
+            return;
+        }
+
+        Geometry::Bounds combinedBounds = m_Meshes[0].bounds;
+        for (const auto& mesh : m_Meshes)
+        {
+            if (!mesh.vertices.empty())
+                combinedBounds = Geometry::MergeBounds(combinedBounds, mesh.bounds);
+        }
+
+        // --- VBO --- straight from the arena. Vertices dropped by OptimizeVertexFetch leave unused
+        // gaps behind their mesh, which is cheaper than compacting.
+        vbo.data(
+            m_Arena.vertices.get(),
+            m_Arena.vertexCount * sizeof(Vertex),
+            GL_STATIC_DRAW
+        );
+
+        // --- IBO --- indices are mesh-relative, so each one is offset by its mesh's first vertex
+        const size_t indexBytes = m_Arena.indexCount * sizeof(unsigned int);
+        ibo.data(nullptr, indexBytes, sizeof(unsigned int), GL_STATIC_DRAW);
+        Renderer::GL::StateCache::Current().bindBuffer(GL_COPY_WRITE_BUFFER, ibo.getID());
+        void* mapped = indexBytes > 0 ? glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, indexBytes,
+                                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT) : nullptr;
+        auto writeIndices = [&](unsigned int* out) {
+            for (const auto& mesh : m_Meshes)
+            {
+                const unsigned int baseVertex = static_cast<unsigned int>(mesh.vertices.data() - m_Arena.vertices.get());
+                out = std::transform(mesh.indices.begin(), mesh.indices.end(), out,
+                                     [baseVertex](unsigned int index) { return index + baseVertex; });
+            }
+        };
+        if (mapped)
+        {
+            writeIndices(static_cast<unsigned int*>(mapped));
+            mapped = glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE ? mapped : nullptr;
+        }
+        if (!mapped && indexBytes > 0)
+        {
+            // Mapping failed or the store was lost while mapped
+            std::vector<unsigned int> combinedIndices(m_Arena.indexCount);
+            writeIndices(combinedIndices.data());
+            ibo.subData(0, combinedIndices.data(), indexBytes);
+        }
+
+        // --- VAO ---
+        vao = std::make_shared<Nyx::Renderer::GL::VAO>(m_Arena.indexCount);
+        vao->addVBO(&vbo);
+        vao->attachIndexBuffer(&ibo);
+
+        vao->bind();
+        vao->setLayout(GetVertexLayout());
+        vao->setBounds(combinedBounds);
 
         vao->unbind();
     }
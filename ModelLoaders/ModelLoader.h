@@ -10,10 +10,17 @@
 #include "../Renderer/GL/VAO.h"
 #include "../Renderer/GL/VBO.h"
 #include "../Renderer/GL/IBO.h"
+#include "../Renderer/GL/GeometryArena.h"
+#include "../Geometry/IndexRange.h"
+#include "../Geometry/Bounds.h"
+#include "../Core/Span.h"
 
 
 namespace Nyx
 {
+    struct VertexFormat;
+    struct VertexDequantization;
+
     struct NYX_API Vertex
     {
         float Position[3];
@@ -23,11 +30,55 @@ namespace Nyx
         float Bitangent[3];
     };
 
-    struct NYX_API Mesh
+    // A simplified index list over the same vertices as its Mesh.
+    struct NYX_API MeshLOD
     {
-        std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
-        unsigned int materialIndex;
+        float error = 0.0f; // Geometric deviation from the full mesh, in mesh units
+    };
+
+    struct NYX_API LODConfig
+    {
+        unsigned int levelCount = 4;     // Levels generated in addition to the full mesh
+        float reductionPerLevel = 0.5f;  // Target index count relative to the previous level
+        float maxError = 0.05f;          // Upper bound on error, relative to the mesh radius
+        float attributeWeight = 0.05f;   // Penalty for collapsing across normal/UV changes
+        bool lockBorder = true;          // Keep open boundary vertices fixed
+    };
+
+    struct NYX_API MeshOptimizeConfig
+    {
+        unsigned int cacheSize = 16;     // Post-transform cache entries to optimize for
+        bool optimizeOverdraw = true;    // Reorder triangle clusters front to back
+        float overdrawThreshold = 1.05f; // Vertex cache ACMR increase allowed for overdraw
+        bool optimizeVertexFetch = true; // Renumber vertices in first-use order
+    };
+
+    // Views into storage owned elsewhere: the Model's MeshArena for loaded meshes, or any buffers
+    // the caller keeps alive. Optimizations rewrite the data in place and may shrink vertices.
+    struct NYX_API Mesh
+    {
+        Core::Span<Vertex> vertices;
+        Core::Span<unsigned int> indices;
+        unsigned int materialIndex = 0;
+        std::vector<MeshLOD> lods; // Coarser levels, lods[0] is LOD 1
+        Geometry::Bounds bounds;   // Local space, filled at load
+    };
+
+    // Vertices and indices of every mesh of a model in two allocations, so the model can be
+    // uploaded without gathering the meshes first. Indices stay relative to their mesh.
+    struct NYX_API MeshArena
+    {
+        std::unique_ptr<Vertex[]> vertices;
+        std::unique_ptr<unsigned int[]> indices;
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+
+        // Replaces the storage with uninitialized arrays, invalidating every span into the old one
+        void allocate(size_t vertexCount, size_t indexCount);
+        inline Core::Span<Vertex> vertexRange(size_t first, size_t count) const { return { vertices.get() + first, count }; }
+        inline Core::Span<unsigned int> indexRange(size_t first, size_t count) const { return { indices.get() + first, count }; }
+        inline size_t sizeBytes() const { return vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int); }
     };
 
     struct NYX_API Material
@@ -43,14 +94,61 @@ namespace Nyx
         std::string normalTex;
     };
 
+    struct NYX_API ModelConfig
+    {
+        unsigned int importFlags =
+            aiProcess_Triangulate |
+            aiProcess_GenSmoothNormals |
+            aiProcess_CalcTangentSpace |
+            aiProcess_JoinIdenticalVertices |
+            aiProcess_LimitBoneWeights;
+
+        // Binary mesh cache: skips Assimp entirely when the source file and options are unchanged.
+        bool useMeshCache = false;
+        std::string cacheDirectory; // Empty stores "<model path>.nyxmesh" next to the source file
+
+        // Converts meshes and materials on Core::ThreadPool::GetShared(). Output order matches the serial path.
+        bool parallelProcessing = false;
+
+        // Builds a chain of simplified index lists per mesh (see Geometry/Simplifier.h).
+        bool generateLODs = false;
+        LODConfig lodConfig;
+
+        // Vertex cache, overdraw and vertex fetch optimization of every mesh and LOD
+        // (see Geometry/IndexOptimizer.h). Replaces aiProcess_ImproveCacheLocality.
+        bool optimizeMeshes = true;
+        MeshOptimizeConfig optimizeConfig;
+    };
+
+    struct NYX_API ModelLoadStats
+    {
+        bool cacheHit = false;
+        double importMs = 0.0;   // Assimp ReadFile + post-processing
+        double processMs = 0.0;  // aiScene -> Mesh/Material conversion, LOD generation and optimization
+        double cacheMs = 0.0;    // Hashing the source plus reading or writing the cache
+        double totalMs = 0.0;
+    };
+
         class NYX_API Model
         {
         public:
-            Model(const std::string& path);
+            Model(const std::string& path, const ModelConfig& config = {});
             ~Model() = default;
+            // Meshes point into m_Arena: copies would alias it, moves keep the spans valid
+            Model(const Model&) = delete;
+            Model& operator=(const Model&) = delete;
+            Model(Model&&) = default;
+            Model& operator=(Model&&) = default;
 
             const std::vector<Mesh>& GetMeshes() const { return m_Meshes; }
             const std::vector<Material>& GetMaterials() const { return m_Materials; }
+            const MeshArena& GetArena() const { return m_Arena; }
+            const ModelLoadStats& GetLoadStats() const { return m_LoadStats; }
+
+            // Attribute layout matching Nyx::Vertex, used by every upload path.
+            static std::vector<Renderer::GL::VertexAttribute> GetVertexLayout();
+            // Hash of every config field that changes the loaded meshes
+            static uint64_t ComputeOptionsKey(const ModelConfig& config);
 
             void LoadToVAO(
                 size_t meshIndex,
@@ -58,6 +156,29 @@ namespace Nyx
                 Renderer::GL::IBO& ibo,
                 std::shared_ptr<Renderer::GL::VAO>& vao
             ) const;
+            // Uploads the mesh in a compact encoding (see VertexFormat.h). Quantized formats need
+            // the returned dequantization parameters in the vertex shader.
+            void LoadToVAO(
+                size_t meshIndex,
+                const VertexFormat& format,
+                Renderer::GL::VBO& vbo,
+                Renderer::GL::IBO& ibo,
+                std::shared_ptr<Renderer::GL::VAO>& vao,
+                VertexDequantization* outDequantization = nullptr
+            ) const;
+            // Uploads the mesh with every LOD level appended to the IBO. lodRanges[0] is the full mesh,
+            // lodRanges[i] is Mesh::lods[i - 1]; draw one with Renderer::drawRanges.
+            void LoadLODsToVAO(
+                size_t meshIndex,
+                Renderer::GL::VBO& vbo,
+                Renderer::GL::IBO& ibo,
+                std::shared_ptr<Renderer::GL::VAO>& vao,
+                std::vector<Geometry::IndexRange>& lodRanges
+            ) const;
+            // Suballocates the mesh into a shared arena created with GetVertexLayout() and sizeof(Vertex).
+            Renderer::GL::ArenaAllocation LoadToArena(size_t meshIndex, Renderer::GL::GeometryArena& arena) const;
+            // Uploads the whole arena: the vertices straight from it with one glBufferData, the indices
+            // rebased per mesh while writing them into the mapped IBO.
             void LoadAsComplete(
                 Renderer::GL::VBO& vbo,
                 Renderer::GL::IBO& ibo,
@@ -66,13 +187,19 @@ namespace Nyx
 
         private:
             void LoadModel(const std::string& path);
-            void ProcessNode(aiNode* node, const aiScene* scene);
-            Mesh ProcessMesh(aiMesh* mesh, const aiScene* scene);
-            Material ProcessMaterial(aiMaterial* mat);
+            // dependencies, when given, receives every other file the importer opened (materials, buffers)
+            bool ImportScene(const std::string& path, std::vector<std::string>* dependencies = nullptr);
+            void CollectMeshes(aiNode* node, const aiScene* scene, std::vector<aiMesh*>& outMeshes) const;
+            // Fills outMesh's vertices and indices, already sized from the aiMesh
+            void ProcessMesh(aiMesh* mesh, Mesh& outMesh) const;
+            Material ProcessMaterial(aiMaterial* mat) const;
 
         private:
+            MeshArena m_Arena;
             std::vector<Mesh> m_Meshes;
             std::vector<Material> m_Materials;
             std::string m_Directory;
+            ModelConfig m_Config;
+            ModelLoadStats m_LoadStats;
         };
 }
@@ -0,0 +1,353 @@
+#include "VertexFormat.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace Nyx
+{
+    namespace VertexCodec
+    {
+        void OctEncode(const float n[3], float out[2])
+        {
+            float invL1 = 1.0f / (std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]) + FLT_MIN);
+            float x = n[0] * invL1;
+            float y = n[1] * invL1;
+            if (n[2] < 0.0f)
+            {
+                float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+                float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+                x = fx;
+                y = fy;
+            }
+            out[0] = x;
+            out[1] = y;
+        }
+
+        void OctDecode(const float e[2], float out[3])
+        {
+            float x = e[0], y = e[1];
+            float z = 1.0f - std::fabs(x) - std::fabs(y);
+            float t = std::max(-z, 0.0f);
+            x += x >= 0.0f ? -t : t;
+            y += y >= 0.0f ? -t : t;
+            float len = std::sqrt(x * x + y * y + z * z);
+            float inv = len > 0.0f ? 1.0f / len : 0.0f;
+            out[0] = x * inv;
+            out[1] = y * inv;
+            out[2] = z * inv;
+        }
+
+        uint16_t FloatToHalf(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            uint32_t sign = (bits >> 16) & 0x8000u;
+            uint32_t absBits = bits & 0x7FFFFFFFu;
+
+            if (absBits >= 0x7F800000u) // Inf / NaN
+                return static_cast<uint16_t>(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+            if (absBits >= 0x477FF000u) // Rounds to a value beyond the half range
+                return static_cast<uint16_t>(sign | 0x7C00u);
+            if (absBits < 0x38800000u) // Subnormal half (or zero)
+            {
+                if (absBits < 0x33000000u)
+                    return static_cast<uint16_t>(sign);
+                uint32_t mantissa = (absBits & 0x007FFFFFu) | 0x00800000u;
+                uint32_t shift = 126u - (absBits >> 23);
+                uint32_t half = mantissa >> shift;
+                uint32_t rem = mantissa & ((1u << shift) - 1u);
+                uint32_t mid = 1u << (shift - 1u);
+                if (rem > mid || (rem == mid && (half & 1u)))
+                    ++half;
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            // Normal: rebias exponent and round mantissa to nearest even
+            uint32_t half = ((absBits - 0x38000000u) >> 13);
+            uint32_t rem = absBits & 0x1FFFu;
+            if (rem > 0x1000u || (rem == 0x1000u && (half & 1u)))
+                ++half;
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        float HalfToFloat(uint16_t value)
+        {
+            uint32_t sign = (static_cast<uint32_t>(value) & 0x8000u) << 16;
+            uint32_t exponent = (value >> 10) & 0x1Fu;
+            uint32_t mantissa = value & 0x3FFu;
+            uint32_t bits;
+
+            if (exponent == 0)
+            {
+                if (mantissa == 0)
+                {
+                    bits = sign;
+                }
+                else
+                {
+                    // Renormalize the subnormal
+                    exponent = 127 - 15 + 1;
+                    while (!(mantissa & 0x400u))
+                    {
+                        mantissa <<= 1;
+                        --exponent;
+                    }
+                    mantissa &= 0x3FFu;
+                    bits = sign | (exponent << 23) | (mantissa << 13);
+                }
+            }
+            else if (exponent == 0x1F)
+            {
+                bits = sign | 0x7F800000u | (mantissa << 13);
+            }
+            else
+            {
+                bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+            }
+
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        int16_t PackSnorm16(float value)
+        {
+            value = std::clamp(value, -1.0f, 1.0f);
+            return static_cast<int16_t>(std::lround(value * 32767.0f));
+        }
+
+        float UnpackSnorm16(int16_t value)
+        {
+            return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+        }
+
+        uint16_t PackUnorm16(float value)
+        {
+            value = std::clamp(value, 0.0f, 1.0f);
+            return static_cast<uint16_t>(std::lround(value * 65535.0f));
+        }
+
+        float UnpackUnorm16(uint16_t value)
+        {
+            return static_cast<float>(value) / 65535.0f;
+        }
+
+        uint32_t PackSnorm10_10_10_2(float x, float y, float z, float w)
+        {
+            auto pack = [](float v, float maxValue, uint32_t mask) {
+                int32_t q = static_cast<int32_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * maxValue));
+                return static_cast<uint32_t>(q) & mask;
+            };
+            // -2 rather than -1 for negative w: see the header
+            const uint32_t packedW = w <= -0.5f ? (static_cast<uint32_t>(-2) & 0x3u) : pack(w, 1.0f, 0x3u);
+            return pack(x, 511.0f, 0x3FFu)
+                | (pack(y, 511.0f, 0x3FFu) << 10)
+                | (pack(z, 511.0f, 0x3FFu) << 20)
+                | (packedW << 30);
+        }
+
+        void UnpackSnorm10_10_10_2(uint32_t packed, float out[4])
+        {
+            auto unpack = [](uint32_t bits, int width, float maxValue) {
+                int32_t shift = 32 - width;
+                int32_t q = static_cast<int32_t>(bits << shift) >> shift; // Sign extend
+                return std::max(static_cast<float>(q) / maxValue, -1.0f);
+            };
+            out[0] = unpack(packed & 0x3FFu, 10, 511.0f);
+            out[1] = unpack((packed >> 10) & 0x3FFu, 10, 511.0f);
+            out[2] = unpack((packed >> 20) & 0x3FFu, 10, 511.0f);
+            out[3] = unpack((packed >> 30) & 0x3u, 2, 1.0f);
+        }
+
+        float BitangentSign(const float normal[3], const float tangent[3], const float bitangent[3])
+        {
+            float cx = normal[1] * tangent[2] - normal[2] * tangent[1];
+            float cy = normal[2] * tangent[0] - normal[0] * tangent[2];
+            float cz = normal[0] * tangent[1] - normal[1] * tangent[0];
+            return (cx * bitangent[0] + cy * bitangent[1] + cz * bitangent[2]) < 0.0f ? -1.0f : 1.0f;
+        }
+    }
+
+    GLsizei GetVertexStride(const VertexFormat& format)
+    {
+        GLsizei stride = format.position == PositionEncoding::Unorm16 ? 8 : 12;
+        stride += 4; // Normal
+        stride += format.texCoords == TexCoordEncoding::Float32 ? 8 : 4;
+        stride += format.normals == NormalEncoding::OctSnorm16 ? 8 : 4; // Tangent + bitangent sign
+        return stride;
+    }
+
+    std::vector<Renderer::GL::VertexAttribute> GetVertexLayout(const VertexFormat& format)
+    {
+        GLsizei stride = GetVertexStride(format);
+        std::vector<Renderer::GL::VertexAttribute> layout;
+        size_t offset = 0;
+
+        if (format.position == PositionEncoding::Unorm16)
+        {
+            layout.push_back({ 0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, offset });
+            offset += 8;
+        }
+        else
+        {
+            layout.push_back({ 0, 3, GL_FLOAT, GL_FALSE, stride, offset });
+            offset += 12;
+        }
+
+        if (format.normals == NormalEncoding::OctSnorm16)
+            layout.push_back({ 1, 2, GL_SHORT, GL_TRUE, stride, offset });
+        else
+            layout.push_back({ 1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset });
+        offset += 4;
+
+        switch (format.texCoords)
+        {
+        case TexCoordEncoding::Float32:
+            layout.push_back({ 2, 2, GL_FLOAT, GL_FALSE, stride, offset });
+            offset += 8;
+            break;
+        case TexCoordEncoding::Half16:
+            layout.push_back({ 2, 2, GL_HALF_FLOAT, GL_FALSE, stride, offset });
+            offset += 4;
+            break;
+        case TexCoordEncoding::Unorm16:
+            layout.push_back({ 2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, offset });
+            offset += 4;
+            break;
+        }
+
+        if (format.normals == NormalEncoding::OctSnorm16)
+            layout.push_back({ 3, 4, GL_SHORT, GL_TRUE, stride, offset });
+        else
+            layout.push_back({ 3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset });
+
+        return layout;
+    }
+
+    EncodedVertices EncodeVertices(const Mesh& mesh, const VertexFormat& format)
+    {
+        using namespace VertexCodec;
+
+        EncodedVertices out;
+        out.stride = GetVertexStride(format);
+        out.layout = GetVertexLayout(format);
+        out.data.resize(mesh.vertices.size() * out.stride);
+
+        VertexDequantization& dq = out.dequantization;
+        if (!mesh.vertices.empty())
+        {
+            float posMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, posMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            float uvMin[2] = { FLT_MAX, FLT_MAX }, uvMax[2] = { -FLT_MAX, -FLT_MAX };
+            for (const Vertex& v : mesh.vertices)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    posMin[c] = std::min(posMin[c], v.Position[c]);
+                    posMax[c] = std::max(posMax[c], v.Position[c]);
+                }
+                for (int c = 0; c < 2; ++c)
+                {
+                    uvMin[c] = std::min(uvMin[c], v.TexCoords[c]);
+                    uvMax[c] = std::max(uvMax[c], v.TexCoords[c]);
+                }
+            }
+
+            if (format.position == PositionEncoding::Unorm16)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    dq.positionOffset[c] = posMin[c];
+                    dq.positionScale[c] = posMax[c] > posMin[c] ? posMax[c] - posMin[c] : 1.0f;
+                }
+            }
+            if (format.texCoords == TexCoordEncoding::Unorm16)
+            {
+                for (int c = 0; c < 2; ++c)
+                {
+                    dq.texCoordOffset[c] = uvMin[c];
+                    dq.texCoordScale[c] = uvMax[c] > uvMin[c] ? uvMax[c] - uvMin[c] : 1.0f;
+                }
+            }
+        }
+
+        unsigned char* dst = out.data.data();
+        for (const Vertex& v : mesh.vertices)
+        {
+            unsigned char* p = dst;
+
+            if (format.position == PositionEncoding::Unorm16)
+            {
+                uint16_t q[4] = { 0, 0, 0, 0 };
+                for (int c = 0; c < 3; ++c)
+                    q[c] = PackUnorm16((v.Position[c] - dq.positionOffset[c]) / dq.positionScale[c]);
+                std::memcpy(p, q, sizeof(q));
+                p += sizeof(q);
+            }
+            else
+            {
+                std::memcpy(p, v.Position, sizeof(v.Position));
+                p += sizeof(v.Position);
+            }
+
+            float octNormal[2], octTangent[2];
+            OctEncode(v.Normal, octNormal);
+            OctEncode(v.Tangent, octTangent);
+            float sign = BitangentSign(v.Normal, v.Tangent, v.Bitangent);
+
+            if (format.normals == NormalEncoding::OctSnorm16)
+            {
+                int16_t n[2] = { PackSnorm16(octNormal[0]), PackSnorm16(octNormal[1]) };
+                std::memcpy(p, n, sizeof(n));
+                p += sizeof(n);
+            }
+            else
+            {
+                uint32_t n = PackSnorm10_10_10_2(octNormal[0], octNormal[1], 0.0f, 0.0f);
+                std::memcpy(p, &n, sizeof(n));
+                p += sizeof(n);
+            }
+
+            switch (format.texCoords)
+            {
+            case TexCoordEncoding::Float32:
+                std::memcpy(p, v.TexCoords, sizeof(v.TexCoords));
+                p += sizeof(v.TexCoords);
+                break;
+            case TexCoordEncoding::Half16:
+            {
+                uint16_t uv[2] = { FloatToHalf(v.TexCoords[0]), FloatToHalf(v.TexCoords[1]) };
+                std::memcpy(p, uv, sizeof(uv));
+                p += sizeof(uv);
+                break;
+            }
+            case TexCoordEncoding::Unorm16:
+            {
+                uint16_t uv[2] = {
+                    PackUnorm16((v.TexCoords[0] - dq.texCoordOffset[0]) / dq.texCoordScale[0]),
+                    PackUnorm16((v.TexCoords[1] - dq.texCoordOffset[1]) / dq.texCoordScale[1])
+                };
+                std::memcpy(p, uv, sizeof(uv));
+                p += sizeof(uv);
+                break;
+            }
+            }
+
+            if (format.normals == NormalEncoding::OctSnorm16)
+            {
+                int16_t t[4] = { PackSnorm16(octTangent[0]), PackSnorm16(octTangent[1]), 0, PackSnorm16(sign) };
+                std::memcpy(p, t, sizeof(t));
+            }
+            else
+            {
+                uint32_t t = PackSnorm10_10_10_2(octTangent[0], octTangent[1], 0.0f, sign);
+                std::memcpy(p, &t, sizeof(t));
+            }
+
+            dst += out.stride;
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "ModelLoader.h"
+#include <cstdint>
+#include <vector>
+
+namespace Nyx
+{
+    enum class PositionEncoding
+    {
+        Float32,    // 12 bytes
+        Unorm16     // 8 bytes, quantized against the mesh AABB
+    };
+
+    enum class NormalEncoding
+    {
+        OctSnorm16,     // normal 4 bytes, tangent 8 bytes
+        Oct10_10_10_2   // normal 4 bytes, tangent 4 bytes
+    };
+
+    enum class TexCoordEncoding
+    {
+        Float32,    // 8 bytes
+        Half16,     // 4 bytes
+        Unorm16     // 4 bytes, quantized against the mesh UV bounds
+    };
+
+    /**
+     * Compact alternative to the 56 byte Nyx::Vertex layout.
+     *
+     * Attribute locations match Model::GetVertexLayout() except that location 4 (bitangent)
+     * is gone: the tangent becomes a vec4 whose w holds the bitangent sign.
+     * Normals and tangents are octahedral encoded and must be decoded in the vertex shader:
+     *
+     *     vec3 octDecode(vec2 e) {
+     *         vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+     *         float t = max(-n.z, 0.0);
+     *         n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+     *         return normalize(n);
+     *     }
+     *     vec3 normal    = octDecode(aNormal.xy);
+     *     vec3 tangent   = octDecode(aTangent.xy);
+     *     vec3 bitangent = cross(normal, tangent) * aTangent.w;
+     *
+     * The packed w reads back as exactly -1 or +1 on GL 3.3 as well, see PackSnorm10_10_10_2.
+     *
+     * Quantized positions/UVs are restored with value = offset + scale * attribute,
+     * using the values in VertexDequantization.
+     */
+    struct NYX_API VertexFormat
+    {
+        PositionEncoding position = PositionEncoding::Float32;
+        NormalEncoding normals = NormalEncoding::Oct10_10_10_2;
+        TexCoordEncoding texCoords = TexCoordEncoding::Half16;
+    };
+
+    struct NYX_API VertexDequantization
+    {
+        float positionOffset[3] = { 0.0f, 0.0f, 0.0f };
+        float positionScale[3] = { 1.0f, 1.0f, 1.0f };
+        float texCoordOffset[2] = { 0.0f, 0.0f };
+        float texCoordScale[2] = { 1.0f, 1.0f };
+    };
+
+    struct NYX_API EncodedVertices
+    {
+        std::vector<unsigned char> data;
+        GLsizei stride = 0;
+        std::vector<Renderer::GL::VertexAttribute> layout;
+        VertexDequantization dequantization;
+    };
+
+    NYX_API GLsizei GetVertexStride(const VertexFormat& format);
+    NYX_API std::vector<Renderer::GL::VertexAttribute> GetVertexLayout(const VertexFormat& format);
+    NYX_API EncodedVertices EncodeVertices(const Mesh& mesh, const VertexFormat& format);
+
+    // Scalar codecs used by EncodeVertices, exposed so precision can be checked on the CPU.
+    // Expected round-trip bounds: octahedral normals within 0.045 deg (snorm16) and 0.24 deg
+    // (10-bit), unorm16 within half a step, half floats bit exact and rounded like _Float16, and w
+    // back as exactly -1 or +1. These were measured with a throwaway program; Nyx ships no test
+    // suite, so nothing checks them automatically.
+    namespace VertexCodec
+    {
+        NYX_API void OctEncode(const float n[3], float out[2]);
+        NYX_API void OctDecode(const float e[2], float out[3]);
+
+        NYX_API uint16_t FloatToHalf(float value);
+        NYX_API float HalfToFloat(uint16_t value);
+
+        NYX_API int16_t PackSnorm16(float value);
+        NYX_API float UnpackSnorm16(int16_t value);
+        NYX_API uint16_t PackUnorm16(float value);
+        NYX_API float UnpackUnorm16(uint16_t value);
+
+        // GL_INT_2_10_10_10_REV, normalized: x/y/z in [-1, 1], w in {-1, 0, 1}. A negative w is stored
+        // as -2, which decodes to -1 under both the GL 3.3-4.1 rule (2c + 1) / 3 and the 4.2+ rule
+        // max(c, -1); a stored -1 would read back as -1/3 on older contexts.
+        NYX_API uint32_t PackSnorm10_10_10_2(float x, float y, float z, float w);
+        NYX_API void UnpackSnorm10_10_10_2(uint32_t packed, float out[4]);
+
+        // +1 or -1 depending on the handedness of the tangent frame.
+        NYX_API float BitangentSign(const float normal[3], const float tangent[3], const float bitangent[3]);
+    }
+}
@@ -0,0 +1,63 @@
+#include "GLCaps.h"
+#include <string_view>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                struct CapsSlot {
+                    GLCaps caps;
+                    bool queried = false;
+                };
+
+                CapsSlot& Slot() {
+                    thread_local CapsSlot slot;
+                    return slot;
+                }
+
+                GLCaps Query() {
+                    GLCaps caps;
+                    glGetIntegerv(GL_MAJOR_VERSION, &caps.major);
+                    glGetIntegerv(GL_MINOR_VERSION, &caps.minor);
+                    caps.textureStorage = caps.hasVersion(4, 2);
+                    caps.multiDrawIndirect = caps.hasVersion(4, 3);
+                    caps.bufferStorage = caps.hasVersion(4, 4);
+
+                    GLint formats = 0;
+                    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+                    caps.programBinary = formats > 0;
+
+                    GLint count = 0;
+                    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+                    for (GLint i = 0; i < count; ++i) {
+                        const GLubyte* name = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+                        if (!name) continue;
+                        std::string_view extension(reinterpret_cast<const char*>(name));
+                        if (extension == "GL_KHR_parallel_shader_compile")
+                            caps.parallelShaderCompile = ParallelCompileExtension::KHR;
+                        else if (extension == "GL_ARB_parallel_shader_compile" && caps.parallelShaderCompile == ParallelCompileExtension::None)
+                            caps.parallelShaderCompile = ParallelCompileExtension::ARB;
+                    }
+                    return caps;
+                }
+            }
+
+            const GLCaps& GLCaps::Current() {
+                CapsSlot& slot = Slot();
+                if (!slot.queried) {
+                    slot.caps = Query();
+                    slot.queried = true;
+                }
+                return slot.caps;
+            }
+
+            void GLCaps::refresh() {
+                CapsSlot& slot = Slot();
+                slot.caps = Query();
+                slot.queried = true;
+            }
+
+        }
+    }
+}
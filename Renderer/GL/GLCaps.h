@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            // Which parallel shader compile extension the context exposes. The KHR and ARB variants
+            // behave the same but load different entry points.
+            enum class ParallelCompileExtension {
+                None,
+                KHR,
+                ARB,
+            };
+
+            /**
+             * Version and feature queries for the current GL context, made once and shared by every Nyx
+             * wrapper that picks a code path at runtime.
+             *
+             * Like StateCache there is one set per thread, matching one context current per thread.
+             * After making a context with a different version current, call refresh().
+             */
+            struct NYX_API GLCaps {
+                int major = 0;
+                int minor = 0;
+
+                bool textureStorage = false;        // glTexStorage2D/3D, GL 4.2
+                bool multiDrawIndirect = false;     // glMultiDrawElementsIndirect, GL 4.3
+                bool bufferStorage = false;         // glBufferStorage, GL 4.4
+                bool programBinary = false;         // At least one glProgramBinary format
+                ParallelCompileExtension parallelShaderCompile = ParallelCompileExtension::None; // KHR preferred
+
+                static const GLCaps& Current();
+                // Queries the current context again
+                static void refresh();
+
+                bool hasVersion(int requiredMajor, int requiredMinor) const {
+                    return major > requiredMajor || (major == requiredMajor && minor >= requiredMinor);
+                }
+            };
+
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include "GeometryArena.h"
+#include "StateCache.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                // First fit. Returns false when no free range is large enough.
+                bool AllocateRange(std::map<uint32_t, uint32_t>& freeRanges, uint32_t count, uint32_t& offset) {
+                    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+                        if (it->second < count) continue;
+                        offset = it->first;
+                        uint32_t remaining = it->second - count;
+                        freeRanges.erase(it);
+                        if (remaining > 0) freeRanges.emplace(offset + count, remaining);
+                        return true;
+                    }
+                    return false;
+                }
+
+                // Returns a range to the free list, merging it with its neighbours
+                void ReleaseRange(std::map<uint32_t, uint32_t>& freeRanges, uint32_t offset, uint32_t count) {
+                    if (count == 0) return;
+                    auto next = freeRanges.lower_bound(offset);
+                    if (next != freeRanges.begin()) {
+                        auto previous = std::prev(next);
+                        if (previous->first + previous->second == offset) {
+                            offset = previous->first;
+                            count += previous->second;
+                            freeRanges.erase(previous);
+                        }
+                    }
+                    if (next != freeRanges.end() && offset + count == next->first) {
+                        count += next->second;
+                        freeRanges.erase(next);
+                    }
+                    freeRanges.emplace(offset, count);
+                }
+
+                void CopyBuffer(GLuint source, GLuint destination, GLsizeiptr size) {
+                    if (size == 0) return;
+                    StateCache& state = StateCache::Current();
+                    state.bindBuffer(GL_COPY_READ_BUFFER, source);
+                    state.bindBuffer(GL_COPY_WRITE_BUFFER, destination);
+                    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+                }
+            }
+
+            GeometryArena::GeometryArena(const std::vector<VertexAttribute>& layout, GLsizei vertexStride,
+                                         size_t initialVertices, size_t initialIndices)
+                : m_Layout(layout), m_VertexStride(vertexStride),
+                  m_VertexCapacity(std::max<size_t>(initialVertices, 1)),
+                  m_IndexCapacity(std::max<size_t>(initialIndices, 1))
+            {
+                m_VBO = std::make_unique<VBO>();
+                m_VBO->data(nullptr, static_cast<GLsizeiptr>(m_VertexCapacity * m_VertexStride), GL_STATIC_DRAW);
+                m_IBO = std::make_unique<IBO>();
+                m_IBO->data(nullptr, static_cast<GLsizeiptr>(m_IndexCapacity * sizeof(GLuint)), sizeof(GLuint), GL_STATIC_DRAW);
+
+                m_FreeVertices.emplace(0, static_cast<uint32_t>(m_VertexCapacity));
+                m_FreeIndices.emplace(0, static_cast<uint32_t>(m_IndexCapacity));
+                rebuildVAO();
+            }
+
+            void GeometryArena::rebuildVAO() {
+                m_VAO = std::make_unique<VAO>(0);
+                m_VAO->addVBO(m_VBO.get());
+                m_VAO->attachIndexBuffer(m_IBO.get());
+                m_VAO->setLayout(m_Layout);
+            }
+
+            void GeometryArena::growVertices(size_t minimumCapacity) {
+                size_t capacity = std::max(m_VertexCapacity * 2, minimumCapacity);
+                auto vbo = std::make_unique<VBO>();
+                vbo->data(nullptr, static_cast<GLsizeiptr>(capacity * m_VertexStride), GL_STATIC_DRAW);
+                CopyBuffer(m_VBO->getID(), vbo->getID(), static_cast<GLsizeiptr>(m_VertexCapacity * m_VertexStride));
+
+                ReleaseRange(m_FreeVertices, static_cast<uint32_t>(m_VertexCapacity), static_cast<uint32_t>(capacity - m_VertexCapacity));
+                m_VertexCapacity = capacity;
+                m_VBO = std::move(vbo);
+                rebuildVAO();
+            }
+
+            void GeometryArena::growIndices(size_t minimumCapacity) {
+                size_t capacity = std::max(m_IndexCapacity * 2, minimumCapacity);
+                auto ibo = std::make_unique<IBO>();
+                ibo->data(nullptr, static_cast<GLsizeiptr>(capacity * sizeof(GLuint)), sizeof(GLuint), GL_STATIC_DRAW);
+                CopyBuffer(m_IBO->getID(), ibo->getID(), static_cast<GLsizeiptr>(m_IndexCapacity * sizeof(GLuint)));
+
+                ReleaseRange(m_FreeIndices, static_cast<uint32_t>(m_IndexCapacity), static_cast<uint32_t>(capacity - m_IndexCapacity));
+                m_IndexCapacity = capacity;
+                m_IBO = std::move(ibo);
+                rebuildVAO();
+            }
+
+            ArenaAllocation GeometryArena::allocate(const void* vertices, size_t vertexCount,
+                                                    const unsigned int* indices, size_t indexCount) {
+                ArenaAllocation allocation;
+                if (vertexCount == 0) return allocation;
+
+                const uint32_t vertexRequest = static_cast<uint32_t>(vertexCount);
+                const uint32_t indexRequest = static_cast<uint32_t>(indexCount);
+
+                // Growing appends a free range at the end, so a second attempt always succeeds
+                if (!AllocateRange(m_FreeVertices, vertexRequest, allocation.baseVertex)) {
+                    growVertices(m_VertexCapacity + vertexCount);
+                    AllocateRange(m_FreeVertices, vertexRequest, allocation.baseVertex);
+                }
+                if (indexRequest > 0 && !AllocateRange(m_FreeIndices, indexRequest, allocation.firstIndex)) {
+                    growIndices(m_IndexCapacity + indexCount);
+                    AllocateRange(m_FreeIndices, indexRequest, allocation.firstIndex);
+                }
+                allocation.vertexCount = vertexRequest;
+                allocation.indexCount = indexRequest;
+
+                m_VBO->subData(static_cast<GLintptr>(size_t(allocation.baseVertex) * m_VertexStride), vertices,
+                               static_cast<GLsizeiptr>(vertexCount * m_VertexStride));
+                if (indexCount > 0) {
+                    m_IBO->subData(static_cast<GLintptr>(size_t(allocation.firstIndex) * sizeof(GLuint)), indices,
+                                   static_cast<GLsizeiptr>(indexCount * sizeof(GLuint)));
+                }
+                return allocation;
+            }
+
+            void GeometryArena::release(const ArenaAllocation& allocation) {
+                if (!allocation.isValid()) return;
+                ReleaseRange(m_FreeVertices, allocation.baseVertex, allocation.vertexCount);
+                ReleaseRange(m_FreeIndices, allocation.firstIndex, allocation.indexCount);
+            }
+
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "VAO.h"
+#include "VBO.h"
+#include "IBO.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            // A mesh inside a GeometryArena. Indices are relative to baseVertex.
+            struct NYX_API ArenaAllocation {
+                uint32_t baseVertex = 0;
+                uint32_t vertexCount = 0;
+                uint32_t firstIndex = 0;
+                uint32_t indexCount = 0;
+
+                inline bool isValid() const { return vertexCount != 0; }
+            };
+
+            /**
+             * Shared vertex and index buffers for every mesh with one vertex layout, drawn through a
+             * single VAO. Meshes are suballocated first-fit from free lists and uploaded with subData;
+             * the buffers grow (by copying on the GPU) when they run out of space, which recreates the
+             * VAO, so fetch getVAO() again after allocating.
+             *
+             *   GeometryArena arena(Model::GetVertexLayout(), sizeof(Vertex));
+             *   ArenaAllocation a = model.LoadToArena(0, arena);
+             *   renderer.drawIndirect(arena, &a, 1);
+             */
+            class NYX_API GeometryArena {
+            public:
+                GeometryArena(const std::vector<VertexAttribute>& layout, GLsizei vertexStride,
+                              size_t initialVertices = 1 << 16, size_t initialIndices = 1 << 18);
+                GeometryArena(const GeometryArena&) = delete;
+                GeometryArena& operator=(const GeometryArena&) = delete;
+
+                // Copies vertexCount * stride bytes and indexCount indices into the arena.
+                // Returns an invalid allocation if vertexCount is 0.
+                ArenaAllocation allocate(const void* vertices, size_t vertexCount,
+                                         const unsigned int* indices, size_t indexCount);
+                void release(const ArenaAllocation& allocation);
+
+                inline VAO* getVAO() const { return m_VAO.get(); }
+                inline GLsizei getVertexStride() const { return m_VertexStride; }
+                inline size_t getVertexCapacity() const { return m_VertexCapacity; }
+                inline size_t getIndexCapacity() const { return m_IndexCapacity; }
+
+            private:
+                void growVertices(size_t minimumCapacity);
+                void growIndices(size_t minimumCapacity);
+                void rebuildVAO();
+
+            private:
+                std::vector<VertexAttribute> m_Layout;
+                GLsizei m_VertexStride;
+
+                std::unique_ptr<VBO> m_VBO;
+                std::unique_ptr<IBO> m_IBO;
+                std::unique_ptr<VAO> m_VAO;
+
+                size_t m_VertexCapacity;
+                size_t m_IndexCapacity;
+                std::map<uint32_t, uint32_t> m_FreeVertices;  // offset -> count
+                std::map<uint32_t, uint32_t> m_FreeIndices;
+            };
+
+        }
+    }
+}
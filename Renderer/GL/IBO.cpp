@@ -1,4 +1,5 @@
 #include "IBO.h"
+#include "StateCache.h"
 
 
 namespace Nyx
@@ -11,23 +12,31 @@ namespace Nyx
             {
                 glGenBuffers(1, &m_ID);
             }
+            // Uploads go through GL_COPY_WRITE_BUFFER: the element array binding belongs to whichever
+            // VAO is bound, and uploading must not attach this buffer to it.
             void IBO::data(const void* data, GLsizeiptr size, int dataTypeSize ,GLenum usage)
             {
-                this->bind();
+                StateCache::Current().bindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
                 m_ICount = size / dataTypeSize;
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
+                glBufferData(GL_COPY_WRITE_BUFFER, size, data, usage);
+            }
+            void IBO::subData(GLintptr offset, const void* data, GLsizeiptr size)
+            {
+                StateCache::Current().bindBuffer(GL_COPY_WRITE_BUFFER, m_ID);
+                glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
             }
             IBO::~IBO()
             {
                 glDeleteBuffers(1, &m_ID);
+                StateCache::Current().onBufferDeleted(m_ID);
             }
             void IBO::bind() const
             {
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
+                StateCache::Current().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
             }
             void IBO::unbind() const
             {
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+                StateCache::Current().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
             }
 
 }
@@ -23,6 +23,7 @@ namespace Nyx{
         void data(const void* data, GLsizeiptr size,
                    int dataTypeSize=sizeof(GLuint),
                 GLenum usage = GL_STATIC_DRAW);
+        void subData(GLintptr offset, const void* data, GLsizeiptr size);
         void bind() const;
         void unbind() const;
         GLuint getID() const { return m_ID; }
@@ -0,0 +1,47 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <cstddef>
+#include <vector>
+#include "VAO.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            // Default per-instance record for instanced draws
+            struct NYX_API InstanceData {
+                float transform[16];   // Column-major model matrix
+                float color[4];
+                float custom[4];
+            };
+
+            /**
+             * Attributes for an InstanceData stream stored in the VAO's VBO number vboIndex:
+             *   layout(location = first)     in mat4 a_InstanceTransform;   // uses first .. first + 3
+             *   layout(location = first + 4) in vec4 a_InstanceColor;
+             *   layout(location = first + 5) in vec4 a_InstanceCustom;
+             */
+            inline std::vector<VertexAttribute> GetInstanceLayout(GLuint firstLocation, GLuint vboIndex) {
+                const GLsizei stride = sizeof(InstanceData);
+                std::vector<VertexAttribute> layout;
+                for (GLuint column = 0; column < 4; ++column) {
+                    layout.push_back({ firstLocation + column, 4, GL_FLOAT, GL_FALSE, stride,
+                                       offsetof(InstanceData, transform) + column * 4 * sizeof(float), vboIndex, 1 });
+                }
+                layout.push_back({ firstLocation + 4, 4, GL_FLOAT, GL_FALSE, stride, offsetof(InstanceData, color), vboIndex, 1 });
+                layout.push_back({ firstLocation + 5, 4, GL_FLOAT, GL_FALSE, stride, offsetof(InstanceData, custom), vboIndex, 1 });
+                return layout;
+            }
+
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include "ProgramBinaryCache.h"
+#include "GLCaps.h"
+#include "../../Core/Hash.h"
+#include "../../IO/MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                constexpr uint32_t kMagic = 0x5058594E; // "NYXP"
+
+                struct BinaryHeader {
+                    uint32_t magic;
+                    uint32_t version;
+                    uint64_t key;
+                    uint32_t format;
+                    uint32_t length;
+                };
+
+                uint64_t HashGLString(uint64_t hash, GLenum name) {
+                    const GLubyte* value = glGetString(name);
+                    return Core::HashString(value ? reinterpret_cast<const char*>(value) : "", hash);
+                }
+
+                uint64_t DriverHash() {
+                    thread_local uint64_t hash = 0;
+                    if (hash == 0) {
+                        hash = HashGLString(Core::kFNVOffsetBasis, GL_VENDOR);
+                        hash = HashGLString(hash, GL_RENDERER);
+                        hash = HashGLString(hash, GL_VERSION);
+                    }
+                    return hash;
+                }
+            }
+
+            bool ProgramBinaryCache::IsSupported() {
+                return GLCaps::Current().programBinary;
+            }
+
+            uint64_t ProgramBinaryCache::ComputeKey(const std::string& vertexSource, const std::string& fragmentSource) {
+                uint64_t key = Core::HashBytes(vertexSource.data(), vertexSource.size());
+                key = Core::HashCombine(key, vertexSource.size());
+                key = Core::HashBytes(fragmentSource.data(), fragmentSource.size(), key);
+                key = Core::HashCombine(key, fragmentSource.size());
+                key = Core::HashCombine(key, DriverHash());
+                key = Core::HashCombine(key, kVersion);
+                return key;
+            }
+
+            std::string ProgramBinaryCache::GetCachePath(uint64_t key, const std::string& cacheDirectory) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "%016llx.nyxprog", static_cast<unsigned long long>(key));
+                return (std::filesystem::path(cacheDirectory) / name).string();
+            }
+
+            bool ProgramBinaryCache::Load(const std::string& cachePath, uint64_t key, GLuint program) {
+                if (!IsSupported()) return false;
+
+                std::error_code ec;
+                if (!std::filesystem::exists(cachePath, ec)) return false;
+                IO::MappedFile file;
+                if (!file.open(cachePath)) return false;
+
+                BinaryHeader header;
+                if (file.size() < sizeof(header)) return false;
+                std::memcpy(&header, file.data(), sizeof(header));
+                if (header.magic != kMagic || header.version != kVersion || header.key != key ||
+                    header.length > file.size() - sizeof(header))
+                    return false;
+
+                glProgramBinary(program, header.format, file.data() + sizeof(header), static_cast<GLsizei>(header.length));
+                // Drivers reject binaries from other driver builds even when the strings match
+                GLint linked = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &linked);
+                return linked == GL_TRUE;
+            }
+
+            bool ProgramBinaryCache::Save(const std::string& cachePath, uint64_t key, GLuint program) {
+                if (!IsSupported()) return false;
+
+                GLint length = 0;
+                glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+                if (length <= 0) return false;
+
+                std::vector<char> buffer(sizeof(BinaryHeader) + static_cast<size_t>(length));
+                BinaryHeader header = {};
+                header.magic = kMagic;
+                header.version = kVersion;
+                header.key = key;
+                GLenum format = 0;
+                GLsizei written = 0;
+                glGetProgramBinary(program, length, &written, &format, buffer.data() + sizeof(header));
+                if (written <= 0) return false;
+                header.format = format;
+                header.length = static_cast<uint32_t>(written);
+                std::memcpy(buffer.data(), &header, sizeof(header));
+
+                std::error_code ec;
+                std::filesystem::path target(cachePath);
+                if (target.has_parent_path())
+                    std::filesystem::create_directories(target.parent_path(), ec);
+
+                // Temporary file first so a crash never leaves a truncated binary behind
+                std::string tempPath = cachePath + ".tmp";
+                {
+                    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+                    out.write(buffer.data(), static_cast<std::streamsize>(sizeof(header) + header.length));
+                    if (!out) {
+                        std::cerr << "Failed to write program binary cache: " << tempPath << "\n";
+                        return false;
+                    }
+                }
+                std::filesystem::rename(tempPath, target, ec);
+                if (ec) {
+                    std::cerr << "Failed to write program binary cache: " << cachePath << " (" << ec.message() << ")\n";
+                    std::filesystem::remove(tempPath, ec);
+                    return false;
+                }
+                return true;
+            }
+
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <cstdint>
+#include <string>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            // On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+            // Keys cover the final shader sources (defines included) and the driver's vendor, renderer
+            // and version strings, so a driver update invalidates every entry.
+            class NYX_API ProgramBinaryCache {
+            public:
+                // Bump whenever the on-disk layout changes
+                static constexpr uint32_t kVersion = 1;
+
+                // False when the driver exposes no binary formats; Load and Save then do nothing
+                static bool IsSupported();
+
+                static uint64_t ComputeKey(const std::string& vertexSource, const std::string& fragmentSource);
+                static std::string GetCachePath(uint64_t key, const std::string& cacheDirectory);
+
+                // Loads the binary into program. Returns false on a missing, stale or corrupt file, or when
+                // the driver rejects the binary; program can then still be compiled and linked normally.
+                static bool Load(const std::string& cachePath, uint64_t key, GLuint program);
+                // program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+                static bool Save(const std::string& cachePath, uint64_t key, GLuint program);
+            };
+
+        }
+    }
+}
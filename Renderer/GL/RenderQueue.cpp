@@ -0,0 +1,362 @@
+#include "RenderQueue.h"
+#include "StateCache.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                // Positive IEEE floats sort like their bit patterns
+                uint32_t DepthBits(float depth) {
+                    if (!(depth > 0.0f)) return 0;
+                    uint32_t bits;
+                    std::memcpy(&bits, &depth, sizeof(bits));
+                    return bits;
+                }
+
+                // Walks items in the given order and counts the binds the submit loop would issue
+                struct StateTracker {
+                    const Shader* shader = nullptr;
+                    const VAO* vao = nullptr;
+                    GLuint textures[kMaxDrawTextures];
+                    bool first = true;
+
+                    StateTracker() {
+                        for (GLuint& texture : textures) texture = UINT32_MAX;
+                    }
+
+                    bool shaderChanged(const DrawItem& item) const { return first || item.shader != shader; }
+                    bool vaoChanged(const DrawItem& item) const { return first || item.vao != vao; }
+                    bool textureChanged(const DrawItem& item, size_t unit) const {
+                        return item.textures[unit] && item.textures[unit].id != textures[unit];
+                    }
+                };
+
+                // Distinct values each key field can hold, see encodeKey()
+                constexpr size_t kShaderIndexLimit = size_t(1) << 12;
+                constexpr size_t kTextureSetIndexLimit = size_t(1) << 15;  // 15 bits in blended keys
+                constexpr size_t kVAOIndexLimit = size_t(1) << 15;
+
+                constexpr float kIdentity[16] = { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+                constexpr GLsizei kInstanceStride = 16 * sizeof(float);
+
+                bool SameDrawState(const DrawItem& a, const DrawItem& b) {
+                    return a.shader == b.shader && a.vao == b.vao && a.layer == b.layer &&
+                           a.range.firstIndex == b.range.firstIndex && a.range.indexCount == b.range.indexCount &&
+                           a.uniformBlock.offset == b.uniformBlock.offset && a.uniformBlock.size == b.uniformBlock.size &&
+                           std::equal(std::begin(a.textures), std::end(a.textures), std::begin(b.textures));
+                }
+            }
+
+            size_t RenderQueue::TextureSetHash::operator()(const std::array<GLuint, kMaxDrawTextures>& set) const {
+                size_t hash = 1469598103934665603ull;
+                for (GLuint id : set) hash = (hash ^ id) * 1099511628211ull;
+                return hash;
+            }
+
+            RenderQueue::RenderQueue(GLenum drawMode)
+                : m_DrawMode(drawMode)
+            {}
+
+            void RenderQueue::enableAutoInstancing(GLuint transformLocation, GLint materialLocation) {
+                m_AutoInstancing = true;
+                m_InstanceLocation = transformLocation;
+                m_MaterialLocation = materialLocation;
+            }
+
+            void RenderQueue::submit(const DrawItem& item) {
+                if (!item.vao) {
+                    std::cerr << "RenderQueue: draw item without a VAO ignored\n";
+                    return;
+                }
+                if (m_AutoInstancing && (item.vao->getAttributeMask() & instanceAttributeMask())) {
+                    std::cerr << "RenderQueue: draw item ignored, its VAO layout uses instance attribute location "
+                              << m_InstanceLocation << " (material " << m_MaterialLocation << ")\n";
+                    return;
+                }
+                m_Items.push_back(item);
+                m_Keys.push_back(encodeKey(item));
+            }
+
+            uint32_t RenderQueue::instanceAttributeMask() const {
+                uint32_t mask = 0;
+                for (GLuint location = m_InstanceLocation; location < m_InstanceLocation + 4; ++location)
+                    if (location < 32) mask |= 1u << location;
+                if (m_MaterialLocation >= 0 && m_MaterialLocation < 32)
+                    mask |= 1u << m_MaterialLocation;
+                return mask;
+            }
+
+            void RenderQueue::clear() {
+                m_Items.clear();
+                m_Keys.clear();
+            }
+
+            uint32_t RenderQueue::getStateIndex(std::unordered_map<const void*, uint32_t>& indices, const void* state) {
+                auto it = indices.find(state);
+                if (it != indices.end()) return it->second;
+                uint32_t index = static_cast<uint32_t>(indices.size());
+                indices.emplace(state, index);
+                return index;
+            }
+
+            uint32_t RenderQueue::getTextureSetIndex(const DrawItem& item) {
+                std::array<GLuint, kMaxDrawTextures> set = {};
+                for (size_t unit = 0; unit < kMaxDrawTextures; ++unit)
+                    set[unit] = item.textures[unit].id;
+
+                auto it = m_TextureSetIndices.find(set);
+                if (it != m_TextureSetIndices.end()) return it->second;
+                uint32_t index = static_cast<uint32_t>(m_TextureSetIndices.size());
+                m_TextureSetIndices.emplace(set, index);
+                return index;
+            }
+
+            uint64_t RenderQueue::encodeKey(const DrawItem& item) {
+                // Indices beyond a field's width wrap around: that only costs sort quality, never correctness,
+                // because the submit loop compares the actual state. pruneStateIndices() keeps it to frames
+                // that really use that much state.
+                const uint64_t layer = item.layer & 0xF;
+                const uint64_t shader = getStateIndex(m_ShaderIndices, item.shader) & 0xFFF;
+                const uint64_t textures = getTextureSetIndex(item);
+                const uint32_t depth = DepthBits(item.depth);
+
+                if (item.blended) {
+                    return (layer << 60) | (1ull << 59) |
+                           (uint64_t(~depth) << 27) |
+                           (shader << 15) |
+                           (textures & 0x7FFF);
+                }
+
+                const uint64_t vao = getStateIndex(m_VAOIndices, item.vao) & 0x7FFF;
+                return (layer << 60) |
+                       (shader << 47) |
+                       ((textures & 0xFFFF) << 31) |
+                       (vao << 16) |
+                       (depth >> 16);
+            }
+
+            void RenderQueue::pruneStateIndices() {
+                // Streamed-out shaders, VAOs and textures leave their entries behind. Once a map outgrows its
+                // key field, start it over: the next frame numbers only the state it uses, densely from 0.
+                if (m_ShaderIndices.size() > kShaderIndexLimit) m_ShaderIndices.clear();
+                if (m_VAOIndices.size() > kVAOIndexLimit) m_VAOIndices.clear();
+                if (m_TextureSetIndices.size() > kTextureSetIndexLimit) m_TextureSetIndices.clear();
+            }
+
+            void RenderQueue::sortKeys() {
+                const size_t count = m_Keys.size();
+                m_Order.resize(count);
+                for (size_t i = 0; i < count; ++i) m_Order[i] = static_cast<uint32_t>(i);
+
+                m_KeyScratch.resize(count);
+                m_OrderScratch.resize(count);
+                std::vector<uint64_t>& keys = m_SortKeys;
+                keys.assign(m_Keys.begin(), m_Keys.end());
+
+                // LSD radix sort, one byte per pass; passes where every key has the same byte are skipped
+                for (int shift = 0; shift < 64; shift += 8) {
+                    size_t histogram[256] = {};
+                    for (uint64_t key : keys) ++histogram[(key >> shift) & 0xFF];
+                    if (histogram[(keys[0] >> shift) & 0xFF] == count) continue;
+
+                    size_t offset = 0;
+                    for (size_t& bucket : histogram) {
+                        size_t bucketCount = bucket;
+                        bucket = offset;
+                        offset += bucketCount;
+                    }
+                    for (size_t i = 0; i < count; ++i) {
+                        size_t slot = histogram[(keys[i] >> shift) & 0xFF]++;
+                        m_KeyScratch[slot] = keys[i];
+                        m_OrderScratch[slot] = m_Order[i];
+                    }
+                    keys.swap(m_KeyScratch);
+                    m_Order.swap(m_OrderScratch);
+                }
+            }
+
+            size_t RenderQueue::countStateChanges(const std::vector<uint32_t>& order) const {
+                StateTracker state;
+                size_t changes = 0;
+                for (size_t i = 0; i < m_Items.size(); ++i) {
+                    const DrawItem& item = m_Items[order.empty() ? i : order[i]];
+                    if (state.shaderChanged(item)) { state.shader = item.shader; ++changes; }
+                    if (state.vaoChanged(item)) { state.vao = item.vao; ++changes; }
+                    for (size_t unit = 0; unit < kMaxDrawTextures; ++unit) {
+                        if (state.textureChanged(item, unit)) { state.textures[unit] = item.textures[unit].id; ++changes; }
+                    }
+                    state.first = false;
+                }
+                return changes;
+            }
+
+            size_t RenderQueue::findInstanceRun(size_t start) const {
+                const DrawItem& first = m_Items[m_Order[start]];
+                size_t end = start + 1;
+                while (end < m_Order.size()) {
+                    const DrawItem& next = m_Items[m_Order[end]];
+                    if (next.setUniforms || !SameDrawState(first, next)) break;
+                    ++end;
+                }
+                return end - start;
+            }
+
+            void RenderQueue::uploadInstanceTransforms() {
+                // One stream region per flush: every transform, then every material index.
+                // A larger frame replaces the stream with one twice its size.
+                const bool materials = m_MaterialLocation >= 0;
+                const GLsizeiptr transformBytes = static_cast<GLsizeiptr>(m_Order.size()) * kInstanceStride;
+                const GLsizeiptr size = transformBytes + (materials ? static_cast<GLsizeiptr>(m_Order.size() * sizeof(uint32_t)) : 0);
+                if (!m_InstanceStream || m_InstanceStream->getFrameSize() < size) {
+                    GLsizeiptr frameSize = m_InstanceStream ? m_InstanceStream->getFrameSize() : GLsizeiptr(64 * 1024);
+                    while (frameSize < size) frameSize *= 2;
+                    m_InstanceStream = std::make_unique<StreamBuffer>(frameSize, GL_ARRAY_BUFFER);
+                }
+
+                m_InstanceStream->beginFrame();
+                StreamAllocation allocation = m_InstanceStream->allocate(size, kInstanceStride);
+                uint8_t* out = static_cast<uint8_t*>(allocation.data);
+                for (uint32_t index : m_Order) {
+                    const float* transform = m_Items[index].transform ? m_Items[index].transform : kIdentity;
+                    std::memcpy(out, transform, kInstanceStride);
+                    out += kInstanceStride;
+                }
+                if (materials) {
+                    for (uint32_t index : m_Order) {
+                        std::memcpy(out, &m_Items[index].material, sizeof(uint32_t));
+                        out += sizeof(uint32_t);
+                    }
+                }
+                m_InstanceStream->flush();
+                m_InstanceOffset = allocation.offset;
+                m_MaterialOffset = allocation.offset + transformBytes;
+            }
+
+            void RenderQueue::bindInstanceAttributes(VAO* vao, size_t firstInstance) {
+                StateCache::Current().bindBuffer(GL_ARRAY_BUFFER, m_InstanceStream->getID());
+                const bool setup = m_InstancedVAOs.insert(vao->getID()).second;
+
+                // Re-pointing the attributes at the run's first transform works on every GL 3.3 context,
+                // unlike a base instance
+                for (GLuint column = 0; column < 4; ++column) {
+                    const GLuint location = m_InstanceLocation + column;
+                    if (setup) {
+                        glEnableVertexAttribArray(location);
+                        glVertexAttribDivisor(location, 1);
+                    }
+                    const uintptr_t offset = m_InstanceOffset + firstInstance * kInstanceStride + column * 4 * sizeof(float);
+                    glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, kInstanceStride, reinterpret_cast<const void*>(offset));
+                }
+                if (m_MaterialLocation >= 0) {
+                    const GLuint location = static_cast<GLuint>(m_MaterialLocation);
+                    if (setup) {
+                        glEnableVertexAttribArray(location);
+                        glVertexAttribDivisor(location, 1);
+                    }
+                    const uintptr_t offset = m_MaterialOffset + firstInstance * sizeof(uint32_t);
+                    glVertexAttribIPointer(location, 1, GL_UNSIGNED_INT, sizeof(uint32_t), reinterpret_cast<const void*>(offset));
+                }
+            }
+
+            void RenderQueue::releaseInstanceAttributes() {
+                // The instance arrays live on the caller's VAOs: turn them off so draws outside the queue
+                // read the VAO's own layout again
+                for (GLuint vao : m_InstancedVAOs) {
+                    StateCache::Current().bindVertexArray(vao);
+                    for (GLuint location = m_InstanceLocation; location < m_InstanceLocation + 4; ++location) {
+                        glVertexAttribDivisor(location, 0);
+                        glDisableVertexAttribArray(location);
+                    }
+                    if (m_MaterialLocation >= 0) {
+                        glVertexAttribDivisor(static_cast<GLuint>(m_MaterialLocation), 0);
+                        glDisableVertexAttribArray(static_cast<GLuint>(m_MaterialLocation));
+                    }
+                }
+                m_InstancedVAOs.clear();
+            }
+
+            void RenderQueue::flush() {
+                m_Stats = {};
+                m_Stats.items = m_Items.size();
+                if (m_Items.empty()) return;
+
+                m_Stats.unsortedStateChanges = countStateChanges({});
+                sortKeys();
+
+                if (m_AutoInstancing) uploadInstanceTransforms();
+                if (m_UniformAllocator) m_UniformAllocator->flush();
+
+                // GL state is unknown on entry: the first item binds everything it uses
+                StateTracker state;
+                UniformHandle transformUniform;
+                for (size_t position = 0; position < m_Order.size();) {
+                    DrawItem& item = m_Items[m_Order[position]];
+                    const size_t instances = m_AutoInstancing ? findInstanceRun(position) : 1;
+
+                    if (state.shaderChanged(item)) {
+                        state.shader = item.shader;
+                        if (item.shader) {
+                            item.shader->bind();
+                            transformUniform = item.shader->getUniform(m_TransformUniform);
+                        }
+                        else {
+                            StateCache::Current().useProgram(0);
+                        }
+                        ++m_Stats.programChanges;
+                    }
+                    if (state.vaoChanged(item)) {
+                        state.vao = item.vao;
+                        item.vao->bind();
+                        ++m_Stats.vaoChanges;
+                    }
+                    for (size_t unit = 0; unit < kMaxDrawTextures; ++unit) {
+                        if (state.textureChanged(item, unit)) {
+                            state.textures[unit] = item.textures[unit].id;
+                            StateCache::Current().bindTextureUnit(static_cast<GLuint>(unit), item.textures[unit].target, item.textures[unit].id);
+                            ++m_Stats.textureBinds;
+                        }
+                    }
+                    state.first = false;
+
+                    if (item.shader) {
+                        if (item.transform && !m_AutoInstancing) item.shader->setUniformMat4fv(transformUniform, item.transform);
+                        if (item.setUniforms) item.setUniforms(*item.shader, item.uniformData);
+                    }
+                    if (m_UniformAllocator) m_UniformAllocator->bind(m_UniformBinding, item.uniformBlock);
+
+                    GLsizei count = static_cast<GLsizei>(item.range.indexCount ? item.range.indexCount : item.vao->getTotalVertices());
+                    const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(item.range.firstIndex) * sizeof(GLuint));
+                    if (m_AutoInstancing) {
+                        bindInstanceAttributes(item.vao, position);
+                        if (item.vao->hasIBO())
+                            glDrawElementsInstanced(m_DrawMode, count, GL_UNSIGNED_INT, offset, static_cast<GLsizei>(instances));
+                        else
+                            glDrawArraysInstanced(m_DrawMode, static_cast<GLint>(item.range.firstIndex), count, static_cast<GLsizei>(instances));
+                        if (instances > 1) ++m_Stats.instancedDraws;
+                    }
+                    else if (item.vao->hasIBO()) {
+                        glDrawElements(m_DrawMode, count, GL_UNSIGNED_INT, offset);
+                    }
+                    else {
+                        glDrawArrays(m_DrawMode, static_cast<GLint>(item.range.firstIndex), count);
+                    }
+                    ++m_Stats.drawCalls;
+                    position += instances;
+                }
+
+                if (m_AutoInstancing) {
+                    m_InstanceStream->endFrame();
+                    releaseInstanceAttributes();
+                }
+                m_Stats.stateChanges = m_Stats.programChanges + m_Stats.vaoChanges + m_Stats.textureBinds;
+                pruneStateIndices();
+                clear();
+            }
+
+        } // namespace GL
+    } // namespace Renderer
+} // namespace Nyx
@@ -0,0 +1,180 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "UniformAllocator.h"
+#include "Texture2D.h"
+#include "Texture2DArray.h"
+#include "VAO.h"
+#include "../../Geometry/IndexRange.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            constexpr size_t kMaxDrawTextures = 4;
+
+            // A texture slot of a draw item. Assign a Texture2D* or Texture2DArray*; nullptr leaves the unit alone.
+            struct NYX_API TextureBinding {
+                GLuint id = 0;
+                GLenum target = GL_TEXTURE_2D;
+
+                TextureBinding() = default;
+                TextureBinding(std::nullptr_t) {}
+                TextureBinding(Texture2D* texture) : id(texture ? texture->id() : 0) {}
+                TextureBinding(Texture2DArray* array) : id(array ? array->id() : 0), target(GL_TEXTURE_2D_ARRAY) {}
+
+                explicit operator bool() const { return id != 0; }
+                bool operator==(const TextureBinding& other) const { return id == other.id && target == other.target; }
+            };
+
+            struct NYX_API DrawItem {
+                Shader* shader = nullptr;
+                VAO* vao = nullptr;
+                TextureBinding textures[kMaxDrawTextures];   // textures[i] is bound to unit i
+                Geometry::IndexRange range = { 0, 0 };       // indexCount == 0 draws the whole VAO
+
+                // Per-draw uniforms. transform is uploaded as a mat4 to the queue's transform uniform,
+                // setUniforms is called with uniformData after the shader is bound.
+                const float* transform = nullptr;
+                void (*setUniforms)(Shader& shader, const void* uniformData) = nullptr;
+                const void* uniformData = nullptr;
+                // Block pushed to the queue's UniformAllocator, bound with glBindBufferRange before the draw
+                StreamAllocation uniformBlock;
+                // With auto-instancing and a material location, streamed as a per-instance uint. Items that
+                // differ only in material still merge, e.g. a TexturePacker region index.
+                uint32_t material = 0;
+
+                uint8_t layer = 0;       // 0-15, lower layers draw first
+                bool blended = false;    // Sorted back to front within its layer instead of by state
+                float depth = 0.0f;      // View-space distance, used to order draws that share state
+            };
+
+            struct NYX_API RenderQueueStats {
+                size_t items = 0;
+                size_t drawCalls = 0;
+                size_t instancedDraws = 0;        // Draw calls that merged more than one item (auto-instancing)
+                size_t programChanges = 0;
+                size_t vaoChanges = 0;
+                size_t textureBinds = 0;
+                size_t stateChanges = 0;          // programChanges + vaoChanges + textureBinds
+                size_t unsortedStateChanges = 0;  // What the same items would have cost in submission order
+            };
+
+            /**
+             * Collects draw items for a frame, sorts them by a 64-bit state key and submits them
+             * with redundant program, VAO and texture binds skipped.
+             *
+             *   queue.submit(item);    // any number of times
+             *   queue.flush();         // sort, draw, clear
+             *   queue.getStats().stateChanges;
+             *
+             * Opaque keys: layer | 0 | program | texture set | VAO | depth (front to back).
+             * Blended keys: layer | 1 | inverted depth (back to front) | program | texture set.
+             *
+             * With auto-instancing enabled, runs of sorted items that share shader, VAO, textures, range
+             * and layer become one instanced draw. Transforms are then streamed into a per-queue buffer
+             * and read by the shader as a per-instance attribute instead of the transform uniform:
+             *
+             *   queue.enableAutoInstancing(5);   // layout(location = 5) in mat4 a_Model;
+             *   queue.enableAutoInstancing(5, 9); // ... and layout(location = 9) in uint a_Material;
+             *
+             * Locations 0-4 hold Model::GetVertexLayout(). The instance arrays are enabled on each VAO only
+             * for the flush and turned off again afterwards, so later Renderer::draw calls are unaffected.
+             * An item with setUniforms starts a new run, so per-draw uniforms are never lost.
+             */
+            class NYX_API RenderQueue {
+            public:
+                RenderQueue(GLenum drawMode = GL_TRIANGLES);
+                RenderQueue(const RenderQueue&) = delete;
+                RenderQueue& operator=(const RenderQueue&) = delete;
+
+                void submit(const DrawItem& item);
+                void flush();
+                void clear();
+
+                // Uniform that DrawItem::transform is written to (default "u_Model")
+                void setTransformUniform(std::string_view name) { m_TransformUniform = Core::HashString(name); }
+                // Transforms go to the mat4 attribute at locations transformLocation .. transformLocation + 3,
+                // which every VAO drawn by this queue must leave free: submit() rejects items whose VAO layout
+                // uses one of them. A materialLocation >= 0 also streams DrawItem::material to that uint attribute.
+                // Call before submitting the frame's items.
+                void enableAutoInstancing(GLuint transformLocation, GLint materialLocation = -1);
+                void disableAutoInstancing() { m_AutoInstancing = false; }
+                // Allocator that DrawItem::uniformBlock comes from. flush() uploads it and binds each
+                // item's block to bindingPoint; pass nullptr to stop.
+                void setUniformAllocator(UniformAllocator* allocator, GLuint bindingPoint) {
+                    m_UniformAllocator = allocator;
+                    m_UniformBinding = bindingPoint;
+                }
+
+                inline size_t size() const { return m_Items.size(); }
+                inline const RenderQueueStats& getStats() const { return m_Stats; }
+
+            private:
+                uint64_t encodeKey(const DrawItem& item);
+                uint32_t getStateIndex(std::unordered_map<const void*, uint32_t>& indices, const void* state);
+                uint32_t getTextureSetIndex(const DrawItem& item);
+                void pruneStateIndices();
+                void sortKeys();
+                size_t countStateChanges(const std::vector<uint32_t>& order) const;
+                size_t findInstanceRun(size_t start) const;
+                void uploadInstanceTransforms();
+                void bindInstanceAttributes(VAO* vao, size_t firstInstance);
+                void releaseInstanceAttributes();
+                uint32_t instanceAttributeMask() const;
+
+            private:
+                GLenum m_DrawMode;
+                uint64_t m_TransformUniform = Core::HashString("u_Model");
+                UniformAllocator* m_UniformAllocator = nullptr;
+                GLuint m_UniformBinding = 0;
+
+                std::vector<DrawItem> m_Items;
+                std::vector<uint64_t> m_Keys;
+                std::vector<uint32_t> m_Order;
+                std::vector<uint64_t> m_SortKeys;
+                std::vector<uint64_t> m_KeyScratch;
+                std::vector<uint32_t> m_OrderScratch;
+
+                // Dense, stable indices so keys stay compact and consistent across frames. Reset by flush()
+                // when one outgrows its key field.
+                std::unordered_map<const void*, uint32_t> m_ShaderIndices;
+                std::unordered_map<const void*, uint32_t> m_VAOIndices;
+                struct TextureSetHash {
+                    size_t operator()(const std::array<GLuint, kMaxDrawTextures>& set) const;
+                };
+                std::unordered_map<std::array<GLuint, kMaxDrawTextures>, uint32_t, TextureSetHash> m_TextureSetIndices;
+
+                // Auto-instancing
+                bool m_AutoInstancing = false;
+                GLuint m_InstanceLocation = 0;
+                GLint m_MaterialLocation = -1;
+                std::unique_ptr<StreamBuffer> m_InstanceStream;
+                GLintptr m_InstanceOffset = 0;
+                GLintptr m_MaterialOffset = 0;
+                std::unordered_set<GLuint> m_InstancedVAOs;  // VAOs whose instance attributes are enabled until the flush ends
+
+                RenderQueueStats m_Stats;
+            };
+
+        } // namespace GL
+    } // namespace Renderer
+} // namespace Nyx
@@ -1,4 +1,8 @@
 #include "Renderer.h"
+#include "StateCache.h"
+#include "GLCaps.h"
+#include <algorithm>
+#include <cfloat>
 namespace Nyx {
     namespace Renderer {
         namespace GL {
@@ -6,6 +10,40 @@ namespace Nyx {
             Renderer::Renderer(GLenum drawMode)
                 : m_DrawMode(drawMode)
             {}
+            Renderer::~Renderer() {
+                if (m_IndirectBuffer) {
+                    glDeleteBuffers(1, &m_IndirectBuffer);
+                    StateCache::Current().onBufferDeleted(m_IndirectBuffer);
+                }
+            }
+            void Renderer::setCullingFrustum(const Geometry::Frustum& frustum) {
+                m_CullFrustum = frustum;
+                m_FrustumCulling = true;
+            }
+            void Renderer::disableFrustumCulling() {
+                m_FrustumCulling = false;
+                m_Visibility.clear();
+                m_CulledCount = 0;
+            }
+            void Renderer::computeVisibility(const DrawCommand* draws, size_t drawCount) {
+                // VAOs without bounds get an infinite sphere so they always pass
+                static const Geometry::BoundingSphere unbounded{ { 0.0f, 0.0f, 0.0f }, FLT_MAX };
+
+                m_CullSpheres.clear();
+                m_CullSpheres.reserve(drawCount);
+                for (size_t i = 0; i < drawCount; ++i) {
+                    const VAO* vao = draws[i].vao;
+                    if (!vao->hasBounds())
+                        m_CullSpheres.push(unbounded);
+                    else if (draws[i].model)
+                        m_CullSpheres.push(Geometry::TransformSphere(vao->getBounds().sphere, draws[i].model));
+                    else
+                        m_CullSpheres.push(vao->getBounds().sphere);
+                }
+
+                m_Visibility.resize(drawCount);
+                m_CulledCount = drawCount - Geometry::CullSpheres(m_CullFrustum, m_CullSpheres, m_Visibility.data());
+            }
             void Renderer::draw(VAO** vaos, size_t vaoCount,DrawCallback callback, void* userData) {
                 for (size_t i = 0; i < vaoCount; ++i) {
                     VAO* vao = vaos[i];
@@ -26,9 +64,9 @@ namespace Nyx {
                     }
                 }
             }
-            void Renderer::draw(std::shared_ptr<VAO>* vaos, size_t vaoCount, DrawCallback callback, void* userData) {
+            void Renderer::draw(const std::shared_ptr<VAO>* vaos, size_t vaoCount, DrawCallback callback, void* userData) {
                 for (size_t i = 0; i < vaoCount; ++i) {
-                    std::shared_ptr<VAO> vao = vaos[i];
+                    const std::shared_ptr<VAO>& vao = vaos[i];
                     bool skipDraw = false;
                     if (callback) {
                         callback(static_cast<int>(i), vao.get(), m_UserData, skipDraw);
@@ -43,6 +81,95 @@ namespace Nyx {
                     }
                 }
             }
+            void Renderer::draw(const DrawCommand* draws, size_t drawCount, DrawCallback callback, void* userData) {
+                if (m_FrustumCulling) computeVisibility(draws, drawCount);
+
+                for (size_t i = 0; i < drawCount; ++i) {
+                    if (m_FrustumCulling && !m_Visibility[i]) continue;
+                    VAO* vao = draws[i].vao;
+
+                    bool skipDraw = false;
+                    if (callback) {
+                        callback(static_cast<int>(i), vao, userData, skipDraw);
+                    }
+                    if (skipDraw) continue;
+
+                    vao->bind();
+                    if (vao->hasIBO()) {
+                        glDrawElements(m_DrawMode, vao->getTotalVertices(), GL_UNSIGNED_INT, nullptr);
+                    }
+                    else {
+                        glDrawArrays(m_DrawMode, 0, vao->getTotalVertices());
+                    }
+                }
+            }
+            void Renderer::drawRanges(VAO* vao, const Geometry::IndexRange* ranges, size_t rangeCount) {
+                if (rangeCount == 0 || !vao->hasIBO()) return;
+
+                m_RangeCounts.resize(rangeCount);
+                m_RangeOffsets.resize(rangeCount);
+                for (size_t i = 0; i < rangeCount; ++i) {
+                    m_RangeCounts[i] = static_cast<GLsizei>(ranges[i].indexCount);
+                    m_RangeOffsets[i] = reinterpret_cast<const void*>(static_cast<uintptr_t>(ranges[i].firstIndex) * sizeof(GLuint));
+                }
+
+                vao->bind();
+                glMultiDrawElements(m_DrawMode, m_RangeCounts.data(), GL_UNSIGNED_INT, m_RangeOffsets.data(), static_cast<GLsizei>(rangeCount));
+            }
+            void Renderer::drawInstanced(VAO* vao, GLsizei instanceCount, const Geometry::IndexRange* range) {
+                if (instanceCount <= 0) return;
+                vao->bind();
+
+                const GLuint first = range ? range->firstIndex : 0;
+                const GLsizei count = static_cast<GLsizei>(range && range->indexCount ? range->indexCount : vao->getTotalVertices());
+                if (vao->hasIBO()) {
+                    const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(first) * sizeof(GLuint));
+                    glDrawElementsInstanced(m_DrawMode, count, GL_UNSIGNED_INT, offset, instanceCount);
+                }
+                else {
+                    glDrawArraysInstanced(m_DrawMode, static_cast<GLint>(first), count, instanceCount);
+                }
+            }
+            void Renderer::drawIndirect(GeometryArena& arena, const ArenaAllocation* draws, size_t drawCount) {
+                if (drawCount == 0) return;
+                arena.getVAO()->bind();
+
+#ifdef GL_VERSION_4_3
+                if (GLCaps::Current().multiDrawIndirect) {
+                    m_IndirectCommands.resize(drawCount);
+                    for (size_t i = 0; i < drawCount; ++i) {
+                        m_IndirectCommands[i] = {
+                            draws[i].indexCount, 1, draws[i].firstIndex,
+                            static_cast<GLint>(draws[i].baseVertex), static_cast<GLuint>(i)
+                        };
+                    }
+
+                    StateCache& state = StateCache::Current();
+                    if (!m_IndirectBuffer) glGenBuffers(1, &m_IndirectBuffer);
+                    state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+
+                    // Orphan the previous frame's commands instead of waiting for the GPU to finish with them
+                    GLsizeiptr size = static_cast<GLsizeiptr>(drawCount * sizeof(DrawElementsIndirectCommand));
+                    m_IndirectCapacity = std::max(m_IndirectCapacity, size);
+                    glBufferData(GL_DRAW_INDIRECT_BUFFER, m_IndirectCapacity, nullptr, GL_STREAM_DRAW);
+                    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, m_IndirectCommands.data());
+
+                    glMultiDrawElementsIndirect(m_DrawMode, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(drawCount), 0);
+                    return;
+                }
+#endif
+
+                m_RangeCounts.resize(drawCount);
+                m_RangeOffsets.resize(drawCount);
+                m_RangeBaseVertices.resize(drawCount);
+                for (size_t i = 0; i < drawCount; ++i) {
+                    m_RangeCounts[i] = static_cast<GLsizei>(draws[i].indexCount);
+                    m_RangeOffsets[i] = reinterpret_cast<const void*>(static_cast<uintptr_t>(draws[i].firstIndex) * sizeof(GLuint));
+                    m_RangeBaseVertices[i] = static_cast<GLint>(draws[i].baseVertex);
+                }
+                glMultiDrawElementsBaseVertex(m_DrawMode, m_RangeCounts.data(), GL_UNSIGNED_INT, m_RangeOffsets.data(),
+                                              static_cast<GLsizei>(drawCount), m_RangeBaseVertices.data());
+            }
         } // namespace GL
     } // namespace Renderer
 } // namespace Nyx
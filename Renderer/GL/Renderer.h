@@ -11,23 +11,83 @@
 
 #include <functional> // for std::function
 #include <memory>
+#include <vector>
 #include "VAO.h"
 #include "IBO.h"
+#include "GeometryArena.h"
+#include "../../Geometry/IndexRange.h"
+#include "../../Geometry/Culling.h"
 
 namespace Nyx {
     namespace Renderer {
         namespace GL {
 
+            // One draw of a VAO at a position. The same VAO may appear in several commands.
+            struct NYX_API DrawCommand {
+                VAO* vao = nullptr;
+                const float* model = nullptr;   // Column-major mat4 the draw is rendered with, nullptr for identity
+            };
+
             class NYX_API Renderer {
             public:
                 using DrawCallback = std::function<void(int index, VAO* vao, void* userData, bool& skipDraw)>;
 
                 Renderer(GLenum drawMode) ;
+                ~Renderer();
+                Renderer(const Renderer&) = delete;
+                Renderer& operator=(const Renderer&) = delete;
 
+				// Draws every VAO; these overloads know nothing about transforms and never cull
 				void draw(VAO** vaos, size_t vaoCount, DrawCallback callback = nullptr, void* userData = nullptr);
-                void draw(std::shared_ptr<VAO>* vaos,size_t vaoCount, DrawCallback callback = nullptr, void* userData = nullptr);
+                void draw(const std::shared_ptr<VAO>* vaos, size_t vaoCount, DrawCallback callback = nullptr, void* userData = nullptr);
+                // Draws each command, frustum culled when a culling frustum is set. The callback's index is
+                // the command index, so it can set the draw's model uniform.
+                void draw(const DrawCommand* draws, size_t drawCount, DrawCallback callback = nullptr, void* userData = nullptr);
+                // Draws only the given index ranges of an indexed VAO (e.g. the output of
+                // Geometry::CullMeshlets)
+                // with a single glMultiDrawElements call.
+                void drawRanges(VAO* vao, const Geometry::IndexRange* ranges, size_t rangeCount);
+                // Draws meshes of one arena with a single glMultiDrawElementsIndirect (GL 4.3+), or
+                // glMultiDrawElementsBaseVertex on older contexts. Command i gets baseInstance = i, so
+                // per-draw data can be fetched with an instanced attribute or gl_BaseInstance.
+                void drawIndirect(GeometryArena& arena, const ArenaAllocation* draws, size_t drawCount);
+                // Draws the VAO (or one range of it) instanceCount times in one call. Per-instance data
+                // comes from attributes with a divisor, see InstanceData.h.
+                void drawInstanced(VAO* vao, GLsizei instanceCount, const Geometry::IndexRange* range = nullptr);
+
+                // Enables frustum culling in draw(DrawCommand*): the local-space VAO bounds are moved to world
+                // space with each command's model matrix and tested against the frustum in SIMD batches before
+                // the draw loop. Culled commands skip both the callback and the draw. Build the frustum from
+                // projection * view.
+                void setCullingFrustum(const Geometry::Frustum& frustum);
+                void disableFrustumCulling();
+                // Result of the last draw(DrawCommand*): 1 for commands that passed culling, 0 for culled ones
+                inline const std::vector<uint8_t>& getVisibilityMask() const { return m_Visibility; }
+                inline size_t getCulledCount() const { return m_CulledCount; }
+            private:
+                void computeVisibility(const DrawCommand* draws, size_t drawCount);
             private:
                 GLenum m_DrawMode;
+                std::vector<GLsizei> m_RangeCounts;
+                std::vector<const void*> m_RangeOffsets;
+                std::vector<GLint> m_RangeBaseVertices;
+
+                struct DrawElementsIndirectCommand {
+                    GLuint count;
+                    GLuint instanceCount;
+                    GLuint firstIndex;
+                    GLint baseVertex;
+                    GLuint baseInstance;
+                };
+                std::vector<DrawElementsIndirectCommand> m_IndirectCommands;
+                GLuint m_IndirectBuffer = 0;
+                GLsizeiptr m_IndirectCapacity = 0;
+
+                bool m_FrustumCulling = false;
+                Geometry::Frustum m_CullFrustum;
+                Geometry::SphereBatch m_CullSpheres;
+                std::vector<uint8_t> m_Visibility;
+                size_t m_CulledCount = 0;
 
                 DrawCallback m_Callback;
                 void* m_UserData;
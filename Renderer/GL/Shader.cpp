@@ -1,49 +1,275 @@
 #include "Shader.h"
+#include "StateCache.h"
+#include "GLCaps.h"
+#include "ProgramBinaryCache.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 
 
 namespace Nyx {
     namespace Renderer {
         namespace GL {
 
-            Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
+            namespace {
+                using Clock = std::chrono::steady_clock;
+
+                // Not in every loader's core headers
+                constexpr GLenum kCompletionStatusKHR = 0x91B1; // GL_COMPLETION_STATUS_KHR
+                constexpr GLenum kCompletionStatusARB = 0x91B1; // GL_COMPLETION_STATUS_ARB
+
+                double ElapsedMs(Clock::time_point start)
+                {
+                    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                }
+
+                // Defines go after the #version line, which GLSL requires to come first
+                std::string InjectDefines(const std::string& source, const std::vector<ShaderDefine>& defines)
+                {
+                    std::string block;
+                    for (const ShaderDefine& define : defines)
+                        block += "#define " + define.name + " " + define.value + "\n";
+
+                    size_t insertAt = 0;
+                    size_t version = source.find("#version");
+                    if (version != std::string::npos) {
+                        size_t lineEnd = source.find('\n', version);
+                        insertAt = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+                    }
+                    std::string result = source.substr(0, insertAt);
+                    if (insertAt == source.size() && !result.empty() && result.back() != '\n') result += '\n';
+                    return result + block + source.substr(insertAt);
+                }
+            }
+
+            Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath, const ShaderConfig& config)
             {
+                auto start = Clock::now();
                 std::string vertexSrc = readFile(vertexPath);
                 std::string fragmentSrc = readFile(fragmentPath);
-                unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexSrc);
-                unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSrc);
+                m_LoadStats.readMs = ElapsedMs(start);
+
+                std::string cacheDirectory = config.cacheDirectory.empty()
+                    ? std::filesystem::path(vertexPath).parent_path().string()
+                    : config.cacheDirectory;
+                build(std::move(vertexSrc), std::move(fragmentSrc), config, cacheDirectory);
+                m_LoadStats.totalMs = ElapsedMs(start);
+            }
 
+            Shader::Shader(const ShaderSource& source, const ShaderConfig& config)
+            {
+                auto start = Clock::now();
+                build(source.vertex, source.fragment, config, config.cacheDirectory);
+                m_LoadStats.totalMs = ElapsedMs(start);
+            }
+
+            void Shader::build(std::string vertexSrc, std::string fragmentSrc, const ShaderConfig& config,
+                               const std::string& cacheDirectory)
+            {
+                if (!config.defines.empty()) {
+                    vertexSrc = InjectDefines(vertexSrc, config.defines);
+                    fragmentSrc = InjectDefines(fragmentSrc, config.defines);
+                }
                 m_ShaderID = glCreateProgram();
-                glAttachShader(m_ShaderID, vertexShader);
-                glAttachShader(m_ShaderID, fragmentShader);
+
+                const bool useCache = config.useBinaryCache && ProgramBinaryCache::IsSupported();
+                if (useCache) {
+                    auto cacheStart = Clock::now();
+                    m_CacheKey = ProgramBinaryCache::ComputeKey(vertexSrc, fragmentSrc);
+                    m_CachePath = ProgramBinaryCache::GetCachePath(m_CacheKey, cacheDirectory);
+                    m_LoadStats.binaryCacheHit = ProgramBinaryCache::Load(m_CachePath, m_CacheKey, m_ShaderID);
+                    m_LoadStats.cacheMs = ElapsedMs(cacheStart);
+                }
+
+                if (m_LoadStats.binaryCacheHit) {
+                    m_Linked = true;
+                    m_CachePath.clear();
+                    reflect();
+                    return;
+                }
+
+                submitLink(vertexSrc, fragmentSrc, useCache);
+                if (!config.deferLink) finish();
+            }
+
+            void Shader::submitLink(const std::string& vertexSrc, const std::string& fragmentSrc, bool retrievable)
+            {
+                // No status queries here: they would force the driver to finish before returning
+                m_SubmitTime = Clock::now();
+                m_VertexShader = compileShader(GL_VERTEX_SHADER, vertexSrc);
+                m_FragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSrc);
+
+                glAttachShader(m_ShaderID, m_VertexShader);
+                glAttachShader(m_ShaderID, m_FragmentShader);
+                if (retrievable) glProgramParameteri(m_ShaderID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
                 glLinkProgram(m_ShaderID);
+                m_Pending = true;
+            }
 
-                int success;
+            bool Shader::SupportsParallelCompile()
+            {
+                return GLCaps::Current().parallelShaderCompile != ParallelCompileExtension::None;
+            }
+
+            bool Shader::poll()
+            {
+                if (!m_Pending) return true;
+                // The completion query is only valid for the extension the context actually exposes
+                const ParallelCompileExtension extension = GLCaps::Current().parallelShaderCompile;
+                if (extension != ParallelCompileExtension::None) {
+                    GLint complete = GL_FALSE;
+                    glGetProgramiv(m_ShaderID, extension == ParallelCompileExtension::KHR ? kCompletionStatusKHR : kCompletionStatusARB, &complete);
+                    if (!complete) return false;
+                }
+                finish();
+                return true;
+            }
+
+            void Shader::finish()
+            {
+                if (!m_Pending) return;
+                m_Pending = false;
+
+                int success = 0;
                 glGetProgramiv(m_ShaderID, GL_LINK_STATUS, &success);
-                if (!success) {
+                m_Linked = success != 0;
+                if (!m_Linked) {
+                    reportCompileErrors(m_VertexShader, GL_VERTEX_SHADER);
+                    reportCompileErrors(m_FragmentShader, GL_FRAGMENT_SHADER);
                     char infoLog[512];
                     glGetProgramInfoLog(m_ShaderID, 512, nullptr, infoLog);
                     std::cerr << "ERROR::SHADER::PROGRAM::LINK_FAILED\n" << infoLog << std::endl;
                 }
 
-                glDeleteShader(vertexShader);
-                glDeleteShader(fragmentShader);
+                glDetachShader(m_ShaderID, m_VertexShader);
+                glDetachShader(m_ShaderID, m_FragmentShader);
+                glDeleteShader(m_VertexShader);
+                glDeleteShader(m_FragmentShader);
+                m_VertexShader = m_FragmentShader = 0;
+                m_LoadStats.compileMs = ElapsedMs(m_SubmitTime);
+
+                if (m_Linked && !m_CachePath.empty()) {
+                    auto cacheStart = Clock::now();
+                    ProgramBinaryCache::Save(m_CachePath, m_CacheKey, m_ShaderID);
+                    m_LoadStats.cacheMs += ElapsedMs(cacheStart);
+                }
+                m_CachePath.clear();
+                if (m_Linked) reflect();
             }
 
             Shader::~Shader() {
+                if (m_Pending) {
+                    glDeleteShader(m_VertexShader);
+                    glDeleteShader(m_FragmentShader);
+                }
                 glDeleteProgram(m_ShaderID);
             }
 
-            void Shader::bind() const { glUseProgram(m_ShaderID); }
-            void Shader::unbind() const { glUseProgram(0); }
+            void Shader::bind() const { StateCache::Current().useProgram(m_ShaderID); }
+            void Shader::unbind() const { StateCache::Current().useProgram(0); }
+
+            namespace {
+                // GL reports arrays as "name[0]"
+                std::string StripArraySuffix(const char* name, GLsizei length) {
+                    std::string result(name, static_cast<size_t>(length));
+                    if (result.size() > 3 && result.compare(result.size() - 3, 3, "[0]") == 0)
+                        result.resize(result.size() - 3);
+                    return result;
+                }
+
+                template<typename Info>
+                void SortByHash(std::vector<Info>& infos) {
+                    std::sort(infos.begin(), infos.end(), [](const Info& a, const Info& b) { return a.hash < b.hash; });
+                }
+            }
+
+            void Shader::reflect()
+            {
+                // glGetActive* rather than the GL 4.3 program interface queries, so this works on 3.3 contexts
+                GLint count = 0, maxLength = 0;
+                glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORMS, &count);
+                glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+                std::vector<char> name(static_cast<size_t>(std::max(maxLength, 1)));
+
+                m_Uniforms.clear();
+                for (GLuint i = 0; i < static_cast<GLuint>(count); ++i) {
+                    GLsizei length = 0;
+                    GLint size = 0;
+                    GLenum type = 0;
+                    glGetActiveUniform(m_ShaderID, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+                    GLint blockIndex = -1;
+                    glGetActiveUniformsiv(m_ShaderID, 1, &i, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+
+                    ShaderUniformInfo info;
+                    info.name = StripArraySuffix(name.data(), length);
+                    info.hash = Core::HashString(info.name);
+                    info.location = blockIndex < 0 ? glGetUniformLocation(m_ShaderID, name.data()) : -1;
+                    info.type = type;
+                    info.arraySize = size;
+                    info.blockIndex = blockIndex;
+                    // The string setters then never reach glGetUniformLocation for known uniforms
+                    if (info.location >= 0) m_UniformLocationCache.emplace(info.name, info.location);
+                    m_Uniforms.push_back(std::move(info));
+                }
+                SortByHash(m_Uniforms);
+
+                glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+                glGetProgramiv(m_ShaderID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+                name.resize(static_cast<size_t>(std::max(maxLength, 1)));
+                m_UniformBlocks.clear();
+                for (GLuint i = 0; i < static_cast<GLuint>(count); ++i) {
+                    GLsizei length = 0;
+                    glGetActiveUniformBlockName(m_ShaderID, i, static_cast<GLsizei>(name.size()), &length, name.data());
+                    ShaderBlockInfo info;
+                    info.name.assign(name.data(), static_cast<size_t>(length));
+                    info.hash = Core::HashString(info.name);
+                    info.index = i;
+                    info.dataSize = 0;
+                    glGetActiveUniformBlockiv(m_ShaderID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &info.dataSize);
+                    m_UniformBlocks.push_back(std::move(info));
+                }
+                SortByHash(m_UniformBlocks);
+
+                glGetProgramiv(m_ShaderID, GL_ACTIVE_ATTRIBUTES, &count);
+                glGetProgramiv(m_ShaderID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+                name.resize(static_cast<size_t>(std::max(maxLength, 1)));
+                m_Attributes.clear();
+                for (GLuint i = 0; i < static_cast<GLuint>(count); ++i) {
+                    GLsizei length = 0;
+                    GLint size = 0;
+                    GLenum type = 0;
+                    glGetActiveAttrib(m_ShaderID, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+                    ShaderAttributeInfo info;
+                    info.name = StripArraySuffix(name.data(), length);
+                    info.hash = Core::HashString(info.name);
+                    info.location = glGetAttribLocation(m_ShaderID, name.data());
+                    info.type = type;
+                    info.arraySize = size;
+                    m_Attributes.push_back(std::move(info));
+                }
+                SortByHash(m_Attributes);
+            }
+
+            UniformHandle Shader::getUniform(uint64_t nameHash) const
+            {
+                auto it = std::lower_bound(m_Uniforms.begin(), m_Uniforms.end(), nameHash,
+                    [](const ShaderUniformInfo& info, uint64_t hash) { return info.hash < hash; });
+                if (it == m_Uniforms.end() || it->hash != nameHash || it->location < 0)
+                    return {};
+                return { it->location, it->type };
+            }
 
             std::string Shader::readFile(const std::string& path)
             {
-                std::ifstream file(path);
-                if (!file)
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                if (!file) {
                     std::cerr << "Shader file not found: " << path << '\n';
-                std::stringstream ss;
-                ss << file.rdbuf();
-                return ss.str();
+                    return {};
+                }
+                std::string source(static_cast<size_t>(file.tellg()), '\0');
+                file.seekg(0);
+                file.read(source.data(), static_cast<std::streamsize>(source.size()));
+                return source;
             }
 
             unsigned int Shader::compileShader(unsigned int type, const std::string& source)
@@ -52,33 +278,56 @@ namespace Nyx {
                 const char* src = source.c_str();
                 glShaderSource(id, 1, &src, nullptr);
                 glCompileShader(id);
+                return id;
+            }
 
+            void Shader::reportCompileErrors(unsigned int shader, unsigned int type)
+            {
                 int success;
-                glGetShaderiv(id, GL_COMPILE_STATUS, &success);
+                glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
                 if (!success) {
                     char infoLog[512];
-                    glGetShaderInfoLog(id, 512, nullptr, infoLog);
+                    glGetShaderInfoLog(shader, 512, nullptr, infoLog);
                     std::cerr << "ERROR::SHADER::"
                         << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT")
                         << "::COMPILATION_FAILED\n" << infoLog << std::endl;
                 }
-
-                return id;
             }
 
             int Shader::getUniformLocation(const std::string& name)
             {
-                if (m_UniformLocationCache.contains(name))
-                    return m_UniformLocationCache[name];
+                auto it = m_UniformLocationCache.find(name);
+                if (it != m_UniformLocationCache.end())
+                    return it->second;
 
                 int location = glGetUniformLocation(m_ShaderID, name.c_str());
                 if (location == -1)
                     std::cerr << "Warning: uniform '" << name << "' doesn't exist.\n";
 
-                m_UniformLocationCache[name] = location;
+                m_UniformLocationCache.emplace(name, location);
                 return location;
             }
 
+            bool Shader::setUniformBlockBinding(const std::string& blockName, GLuint bindingPoint)
+            {
+                GLuint index = glGetUniformBlockIndex(m_ShaderID, blockName.c_str());
+                if (index == GL_INVALID_INDEX) {
+                    std::cerr << "Warning: uniform block '" << blockName << "' doesn't exist.\n";
+                    return false;
+                }
+                glUniformBlockBinding(m_ShaderID, index, bindingPoint);
+                return true;
+            }
+
+            GLint Shader::getUniformBlockSize(const std::string& blockName) const
+            {
+                GLuint index = glGetUniformBlockIndex(m_ShaderID, blockName.c_str());
+                if (index == GL_INVALID_INDEX) return -1;
+                GLint size = 0;
+                glGetActiveUniformBlockiv(m_ShaderID, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+                return size;
+            }
+
             void Shader::setUniform1i(const std::string& name, int value) {
                 glUniform1i(getUniformLocation(name), value);
             }
@@ -10,20 +10,93 @@
 #error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
 #endif
 
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include "../../Core/Hash.h"
 
 namespace Nyx {
     namespace Renderer {
         namespace GL {
 
+            struct NYX_API ShaderDefine {
+                std::string name;
+                std::string value;
+            };
+
+            struct NYX_API ShaderConfig {
+                std::vector<ShaderDefine> defines;   // Inserted after #version as "#define name value"
+
+                // Program binary cache (see ProgramBinaryCache.h): later runs skip compiling and linking.
+                // Rejected or stale binaries silently fall back to a normal compile.
+                bool useBinaryCache = false;
+                std::string cacheDirectory;          // Empty stores binaries next to the vertex shader
+
+                // Submit compile and link without waiting for the driver. The shader stays pending until
+                // poll() sees the link finish or finish() is called; it must not be used before that.
+                bool deferLink = false;
+            };
+
+            struct NYX_API ShaderSource {
+                std::string vertex;
+                std::string fragment;
+            };
+
+            struct NYX_API ShaderLoadStats {
+                bool binaryCacheHit = false;
+                double readMs = 0.0;
+                double compileMs = 0.0;  // Compile and link, 0 on a cache hit. Deferred links: submit to finish.
+                double cacheMs = 0.0;    // Hashing the sources plus loading or saving the binary
+                double totalMs = 0.0;
+            };
+
+            // Reflected after link. Array uniforms are listed once, under their name without "[0]".
+            struct NYX_API ShaderUniformInfo {
+                std::string name;
+                uint64_t hash;       // Core::HashString(name)
+                GLint location;      // -1 for members of uniform blocks
+                GLenum type;         // GL_FLOAT_MAT4, GL_SAMPLER_2D, ...
+                GLint arraySize;
+                GLint blockIndex;    // -1 for default-block uniforms
+            };
+
+            struct NYX_API ShaderBlockInfo {
+                std::string name;
+                uint64_t hash;
+                GLuint index;
+                GLint dataSize;
+            };
+
+            struct NYX_API ShaderAttributeInfo {
+                std::string name;
+                uint64_t hash;
+                GLint location;
+                GLenum type;
+                GLint arraySize;
+            };
+
+            // A uniform location resolved once; setting through it does no string work or lookups
+            struct NYX_API UniformHandle {
+                GLint location = -1;
+                GLenum type = 0;     // Reflected GL type, so callers can check what they resolved
+
+                inline bool isValid() const { return location >= 0; }
+            };
+
             class NYX_API Shader {
             public:
-                Shader(const std::string& vertexPath, const std::string& fragmentPath);
+                Shader(const std::string& vertexPath, const std::string& fragmentPath, const ShaderConfig& config = {});
+                // From sources in memory; an empty cacheDirectory caches in the working directory
+                Shader(const ShaderSource& source, const ShaderConfig& config = {});
                 ~Shader();
+                Shader(const Shader&) = delete;
+                Shader& operator=(const Shader&) = delete;
 
                 void bind() const;
                 void unbind() const;
@@ -35,14 +108,77 @@ namespace Nyx {
                 void setUniform4f(const std::string& name, float x, float y, float z, float w);
                 void setUniformMat4fv(const std::string& name, const float* matrix, bool transpose = false);
 
+                // Connects the uniform block blockName to a buffer binding point (see UniformAllocator).
+                // Returns false if the program has no such block.
+                bool setUniformBlockBinding(const std::string& blockName, GLuint bindingPoint);
+                // Size in bytes GL expects for the block, or -1 if it does not exist
+                GLint getUniformBlockSize(const std::string& blockName) const;
+
+                /**
+                 * Handles are resolved from the reflection data with a binary search, so do it once at
+                 * load time and keep them. Hash names at compile time:
+                 *
+                 *   static constexpr uint64_t kModel = Nyx::Core::HashString("u_Model");
+                 *   UniformHandle model = shader.getUniform(kModel);
+                 *   shader.setUniformMat4fv(model, matrix);   // per draw
+                 *
+                 * Unknown names return an invalid handle, setting it is a no-op in GL.
+                 */
+                UniformHandle getUniform(uint64_t nameHash) const;
+                UniformHandle getUniform(std::string_view name) const { return getUniform(Core::HashString(name)); }
+
+                inline void setUniform1i(UniformHandle uniform, int value) { glUniform1i(uniform.location, value); }
+                inline void setUniform1f(UniformHandle uniform, float value) { glUniform1f(uniform.location, value); }
+                inline void setUniform2f(UniformHandle uniform, float x, float y) { glUniform2f(uniform.location, x, y); }
+                inline void setUniform3f(UniformHandle uniform, float x, float y, float z) { glUniform3f(uniform.location, x, y, z); }
+                inline void setUniform4f(UniformHandle uniform, float x, float y, float z, float w) { glUniform4f(uniform.location, x, y, z, w); }
+                inline void setUniformMat4fv(UniformHandle uniform, const float* matrix, bool transpose = false) {
+                    glUniformMatrix4fv(uniform.location, 1, transpose ? GL_TRUE : GL_FALSE, matrix);
+                }
+
+                // Reflection, sorted by name hash
+                inline const std::vector<ShaderUniformInfo>& getUniforms() const { return m_Uniforms; }
+                inline const std::vector<ShaderBlockInfo>& getUniformBlocks() const { return m_UniformBlocks; }
+                inline const std::vector<ShaderAttributeInfo>& getAttributes() const { return m_Attributes; }
+
+                // Deferred links (ShaderConfig::deferLink). poll() never blocks when the driver supports
+                // GL_KHR_parallel_shader_compile, otherwise it finishes the link. Both return true once
+                // the shader is no longer pending, linked or not.
+                bool poll();
+                void finish();
+                bool isPending() const { return m_Pending; }
+                static bool SupportsParallelCompile();
+
                 unsigned int getID() const { return m_ShaderID; }
+                bool isLinked() const { return m_Linked; }
+                const ShaderLoadStats& getLoadStats() const { return m_LoadStats; }
 
             private:
-                unsigned int m_ShaderID;
+                unsigned int m_ShaderID = 0;
+                bool m_Linked = false;
+                ShaderLoadStats m_LoadStats;
+
+                // Between submitLink() and finish()
+                bool m_Pending = false;
+                unsigned int m_VertexShader = 0;
+                unsigned int m_FragmentShader = 0;
+                uint64_t m_CacheKey = 0;
+                std::string m_CachePath;
+                std::chrono::steady_clock::time_point m_SubmitTime;
                 std::unordered_map<std::string, int> m_UniformLocationCache;
 
+                std::vector<ShaderUniformInfo> m_Uniforms;
+                std::vector<ShaderBlockInfo> m_UniformBlocks;
+                std::vector<ShaderAttributeInfo> m_Attributes;
+
+                void reflect();
+
                 std::string readFile(const std::string& path);
+                void build(std::string vertexSrc, std::string fragmentSrc, const ShaderConfig& config,
+                           const std::string& cacheDirectory);
+                void submitLink(const std::string& vertexSrc, const std::string& fragmentSrc, bool retrievable);
                 unsigned int compileShader(unsigned int type, const std::string& source);
+                void reportCompileErrors(unsigned int shader, unsigned int type);
                 int getUniformLocation(const std::string& name);
             };
 
@@ -0,0 +1,204 @@
+#include "ShaderLibrary.h"
+#include "GLCaps.h"
+#include "../../Core/Hash.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                using Clock = std::chrono::steady_clock;
+
+                double ElapsedMs(Clock::time_point start)
+                {
+                    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                }
+
+                constexpr int kMaxIncludeDepth = 32;
+
+                // Extension entry points are null when the loader did not resolve them
+                template<typename Function>
+                bool IsLoaded(Function* function) {
+                    return function != nullptr;
+                }
+
+                // Extracts the name from #include "name" or #include <name>
+                bool ParseInclude(const std::string& line, size_t directive, std::string& name) {
+                    size_t open = line.find_first_of("\"<", directive + 8);
+                    if (open == std::string::npos) return false;
+                    size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+                    if (close == std::string::npos) return false;
+                    name = line.substr(open + 1, close - open - 1);
+                    return !name.empty();
+                }
+            }
+
+            ShaderLibrary::ShaderLibrary(const ShaderConfig& baseConfig)
+                : m_BaseConfig(baseConfig)
+            {
+                m_BaseConfig.deferLink = true;
+                m_BaseConfig.defines.clear();
+
+                // Let the driver use as many compiler threads as it likes
+                switch (GLCaps::Current().parallelShaderCompile) {
+                case ParallelCompileExtension::KHR:
+#if defined(GL_KHR_parallel_shader_compile)
+                    if (IsLoaded(glMaxShaderCompilerThreadsKHR)) glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+#endif
+                    break;
+                case ParallelCompileExtension::ARB:
+#if defined(GL_ARB_parallel_shader_compile)
+                    if (IsLoaded(glMaxShaderCompilerThreadsARB)) glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+#endif
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            void ShaderLibrary::addIncludeDirectory(const std::string& directory) {
+                m_IncludeDirectories.emplace_back(directory);
+            }
+
+            const std::string* ShaderLibrary::readSource(const std::filesystem::path& path) {
+                std::string key = path.lexically_normal().string();
+                auto it = m_Files.find(key);
+                if (it != m_Files.end()) return &it->second;
+
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                if (!file) return nullptr;
+                std::string source(static_cast<size_t>(file.tellg()), '\0');
+                file.seekg(0);
+                file.read(source.data(), static_cast<std::streamsize>(source.size()));
+                return &m_Files.emplace(std::move(key), std::move(source)).first->second;
+            }
+
+            std::filesystem::path ShaderLibrary::resolveInclude(const std::filesystem::path& includer, const std::string& name) const {
+                std::error_code ec;
+                std::filesystem::path local = includer.parent_path() / name;
+                if (std::filesystem::exists(local, ec)) return local;
+                for (const std::filesystem::path& directory : m_IncludeDirectories) {
+                    std::filesystem::path candidate = directory / name;
+                    if (std::filesystem::exists(candidate, ec)) return candidate;
+                }
+                return {};
+            }
+
+            bool ShaderLibrary::preprocess(const std::filesystem::path& path, std::string& out,
+                                           std::unordered_set<std::string>& included, int depth) {
+                if (depth > kMaxIncludeDepth) {
+                    std::cerr << "ShaderLibrary: include depth limit reached in " << path.string() << "\n";
+                    return false;
+                }
+                if (!included.insert(path.lexically_normal().string()).second) return true;
+
+                const std::string* source = readSource(path);
+                if (!source) {
+                    std::cerr << "Shader file not found: " << path.string() << "\n";
+                    return false;
+                }
+
+                size_t lineStart = 0;
+                while (lineStart < source->size()) {
+                    size_t lineEnd = source->find('\n', lineStart);
+                    if (lineEnd == std::string::npos) lineEnd = source->size();
+                    std::string line = source->substr(lineStart, lineEnd - lineStart);
+                    lineStart = lineEnd + 1;
+
+                    size_t directive = line.find_first_not_of(" \t");
+                    if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0) {
+                        out += line;
+                        out += '\n';
+                        continue;
+                    }
+
+                    std::string name;
+                    if (!ParseInclude(line, directive, name)) {
+                        std::cerr << "ShaderLibrary: malformed #include in " << path.string() << ": " << line << "\n";
+                        return false;
+                    }
+                    std::filesystem::path resolved = resolveInclude(path, name);
+                    if (resolved.empty()) {
+                        std::cerr << "ShaderLibrary: cannot resolve #include \"" << name << "\" in " << path.string() << "\n";
+                        return false;
+                    }
+                    ++m_Stats.includesResolved;
+                    if (!preprocess(resolved, out, included, depth + 1)) return false;
+                }
+                return true;
+            }
+
+            Shader* ShaderLibrary::load(const std::string& vertexPath, const std::string& fragmentPath,
+                                        const std::vector<ShaderDefine>& defines) {
+                ++m_Stats.requested;
+                auto preprocessStart = Clock::now();
+
+                ShaderSource source;
+                std::unordered_set<std::string> included;
+                if (!preprocess(vertexPath, source.vertex, included, 0)) return nullptr;
+                included.clear();
+                if (!preprocess(fragmentPath, source.fragment, included, 0)) return nullptr;
+
+                // Define order does not change the permutation
+                ShaderConfig config = m_BaseConfig;
+                config.defines = defines;
+                std::sort(config.defines.begin(), config.defines.end(),
+                          [](const ShaderDefine& a, const ShaderDefine& b) { return a.name < b.name; });
+
+                uint64_t key = Core::HashString(source.vertex);
+                key = Core::HashString(source.fragment, key);
+                for (const ShaderDefine& define : config.defines)
+                    key = Core::HashString(define.name + "=" + define.value + "\n", key);
+                m_Stats.preprocessMs += ElapsedMs(preprocessStart);
+
+                auto it = m_Programs.find(key);
+                if (it != m_Programs.end()) return it->second.get();
+
+                if (config.cacheDirectory.empty())
+                    config.cacheDirectory = std::filesystem::path(vertexPath).parent_path().string();
+
+                auto submitStart = Clock::now();
+                auto shader = std::make_unique<Shader>(source, config);
+                m_Stats.submitMs += ElapsedMs(submitStart);
+                ++m_Stats.unique;
+
+                Shader* result = shader.get();
+                if (result->isPending()) m_Pending.push_back(result);
+                else onFinished(*result);
+                m_Stats.pending = m_Pending.size();
+                m_Programs.emplace(key, std::move(shader));
+                return result;
+            }
+
+            void ShaderLibrary::onFinished(const Shader& shader) {
+                if (!shader.isLinked()) ++m_Stats.failed;
+                if (shader.getLoadStats().binaryCacheHit) ++m_Stats.binaryCacheHits;
+            }
+
+            size_t ShaderLibrary::update() {
+                auto finished = std::remove_if(m_Pending.begin(), m_Pending.end(), [this](Shader* shader) {
+                    if (!shader->poll()) return false;
+                    onFinished(*shader);
+                    return true;
+                });
+                m_Pending.erase(finished, m_Pending.end());
+                m_Stats.pending = m_Pending.size();
+                return m_Pending.size();
+            }
+
+            void ShaderLibrary::finishAll() {
+                for (Shader* shader : m_Pending) {
+                    shader->finish();
+                    onFinished(*shader);
+                }
+                m_Pending.clear();
+                m_Stats.pending = 0;
+            }
+
+        }
+    }
+}
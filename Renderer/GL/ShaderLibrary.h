@@ -0,0 +1,93 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Shader.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            struct NYX_API ShaderLibraryStats {
+                size_t requested = 0;        // load() calls
+                size_t unique = 0;           // Programs created; the rest were permutation duplicates
+                size_t pending = 0;          // Still compiling or linking after the last update()
+                size_t failed = 0;
+                size_t binaryCacheHits = 0;
+                size_t includesResolved = 0;
+                double preprocessMs = 0.0;
+                double submitMs = 0.0;       // Time spent inside compile and link submissions
+            };
+
+            /**
+             * Loads many shader permutations at once. Every load() preprocesses the sources (#include
+             * resolution plus defines), returns the existing program when the result matches an earlier
+             * permutation, and otherwise submits compile and link without waiting for the driver.
+             * With GL_KHR_parallel_shader_compile the driver compiles on its own threads and update()
+             * polls completion without blocking.
+             *
+             *   ShaderLibrary library;
+             *   library.addIncludeDirectory("shaders/include");
+             *   for (auto& defines : permutations)
+             *       variants.push_back(library.load("lit.vert", "lit.frag", defines));
+             *   while (library.update() > 0) { drawLoadingScreen(); }
+             *
+             * #include "file" and #include <file> are looked up next to the including file first, then in
+             * the include directories. Each file is included at most once per shader stage.
+             */
+            class NYX_API ShaderLibrary {
+            public:
+                // baseConfig supplies binary cache settings; defines are added per load()
+                ShaderLibrary(const ShaderConfig& baseConfig = {});
+                ShaderLibrary(const ShaderLibrary&) = delete;
+                ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+                void addIncludeDirectory(const std::string& directory);
+
+                // The library owns the shader. Returns nullptr if a source or include is missing.
+                // The shader may still be pending, check isPending() or wait for update() to return 0.
+                Shader* load(const std::string& vertexPath, const std::string& fragmentPath,
+                             const std::vector<ShaderDefine>& defines = {});
+
+                // Finishes the programs whose links completed; returns how many are still pending
+                size_t update();
+                // Blocks until every pending program is linked
+                void finishAll();
+
+                inline size_t size() const { return m_Programs.size(); }
+                inline const ShaderLibraryStats& getStats() const { return m_Stats; }
+
+            private:
+                const std::string* readSource(const std::filesystem::path& path);
+                std::filesystem::path resolveInclude(const std::filesystem::path& includer, const std::string& name) const;
+                bool preprocess(const std::filesystem::path& path, std::string& out,
+                                std::unordered_set<std::string>& included, int depth);
+                void onFinished(const Shader& shader);
+
+            private:
+                ShaderConfig m_BaseConfig;
+                std::vector<std::filesystem::path> m_IncludeDirectories;
+                std::unordered_map<std::string, std::string> m_Files;  // Raw sources by normalized path
+
+                std::unordered_map<uint64_t, std::unique_ptr<Shader>> m_Programs;  // By permutation hash
+                std::vector<Shader*> m_Pending;
+
+                ShaderLibraryStats m_Stats;
+            };
+
+        }
+    }
+}
@@ -0,0 +1,210 @@
+#include "StateCache.h"
+#include <iostream>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                struct TargetInfo {
+                    GLenum target;
+                    GLenum bindingQuery;
+                };
+
+                constexpr TargetInfo kBufferTargetInfo[] = {
+                    { GL_ARRAY_BUFFER,         GL_ARRAY_BUFFER_BINDING },
+                    { GL_ELEMENT_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER_BINDING },
+                    { GL_COPY_READ_BUFFER,     GL_COPY_READ_BUFFER_BINDING },
+                    { GL_COPY_WRITE_BUFFER,    GL_COPY_WRITE_BUFFER_BINDING },
+                    { GL_PIXEL_PACK_BUFFER,    GL_PIXEL_PACK_BUFFER_BINDING },
+                    { GL_PIXEL_UNPACK_BUFFER,  GL_PIXEL_UNPACK_BUFFER_BINDING },
+                    { GL_UNIFORM_BUFFER,       GL_UNIFORM_BUFFER_BINDING },
+#ifdef GL_DRAW_INDIRECT_BUFFER
+                    { GL_DRAW_INDIRECT_BUFFER, GL_DRAW_INDIRECT_BUFFER_BINDING },
+#else
+                    { 0, 0 },
+#endif
+#ifdef GL_SHADER_STORAGE_BUFFER
+                    { GL_SHADER_STORAGE_BUFFER, GL_SHADER_STORAGE_BUFFER_BINDING },
+#else
+                    { 0, 0 },
+#endif
+                };
+
+                constexpr TargetInfo kTextureTargetInfo[] = {
+                    { GL_TEXTURE_2D,       GL_TEXTURE_BINDING_2D },
+                    { GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BINDING_2D_ARRAY },
+                    { GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BINDING_CUBE_MAP },
+                };
+
+                constexpr int kElementArraySlot = 1;
+
+                template<size_t N>
+                int FindSlot(const TargetInfo (&targets)[N], GLenum target) {
+                    for (size_t i = 0; i < N; ++i)
+                        if (targets[i].target == target && target != 0) return static_cast<int>(i);
+                    return -1;
+                }
+            }
+
+            StateCache& StateCache::Current() {
+                thread_local StateCache cache;
+                return cache;
+            }
+
+            StateCache::StateCache() {
+                invalidate();
+            }
+
+            void StateCache::invalidate() {
+                m_Program = kUnknown;
+                m_VAO = kUnknown;
+                m_ActiveUnit = kUnknown;
+                for (GLuint& buffer : m_Buffers) buffer = kUnknown;
+                for (auto& unit : m_Textures)
+                    for (GLuint& texture : unit) texture = kUnknown;
+                for (BufferRange& range : m_UniformRanges) range = { kUnknown, 0, 0 };
+            }
+
+            void StateCache::useProgram(GLuint program) {
+                if (m_Program == program) { ++m_Stats.skipped; return; }
+                glUseProgram(program);
+                m_Program = program;
+                ++m_Stats.issued;
+                if (m_Validate) check(GL_CURRENT_PROGRAM, m_Program, "program");
+            }
+
+            void StateCache::bindVertexArray(GLuint vao) {
+                if (m_VAO == vao) { ++m_Stats.skipped; return; }
+                glBindVertexArray(vao);
+                m_VAO = vao;
+                m_Buffers[kElementArraySlot] = kUnknown;
+                ++m_Stats.issued;
+                if (m_Validate) check(GL_VERTEX_ARRAY_BINDING, m_VAO, "vertex array");
+            }
+
+            void StateCache::bindBuffer(GLenum target, GLuint buffer) {
+                int slot = FindSlot(kBufferTargetInfo, target);
+                if (slot >= 0 && m_Buffers[slot] == buffer) { ++m_Stats.skipped; return; }
+
+                glBindBuffer(target, buffer);
+                ++m_Stats.issued;
+                if (slot < 0) return;
+                m_Buffers[slot] = buffer;
+                if (m_Validate) check(kBufferTargetInfo[slot].bindingQuery, buffer, "buffer");
+            }
+
+            void StateCache::activeTexture(GLuint unit) {
+                if (m_ActiveUnit == unit) { ++m_Stats.skipped; return; }
+                glActiveTexture(GL_TEXTURE0 + unit);
+                m_ActiveUnit = unit;
+                ++m_Stats.issued;
+                if (m_Validate) check(GL_ACTIVE_TEXTURE, GL_TEXTURE0 + unit, "active texture");
+            }
+
+            void StateCache::bindTexture(GLenum target, GLuint texture) {
+                int slot = FindSlot(kTextureTargetInfo, target);
+                bool tracked = slot >= 0 && m_ActiveUnit < kMaxTextureUnits;
+                if (tracked && m_Textures[m_ActiveUnit][slot] == texture) { ++m_Stats.skipped; return; }
+
+                glBindTexture(target, texture);
+                ++m_Stats.issued;
+                if (!tracked) return;
+                m_Textures[m_ActiveUnit][slot] = texture;
+                if (m_Validate) check(kTextureTargetInfo[slot].bindingQuery, texture, "texture");
+            }
+
+            void StateCache::bindTextureUnit(GLuint unit, GLenum target, GLuint texture) {
+                int slot = FindSlot(kTextureTargetInfo, target);
+                if (slot >= 0 && unit < kMaxTextureUnits && m_Textures[unit][slot] == texture) {
+                    ++m_Stats.skipped;
+                    return;
+                }
+                activeTexture(unit);
+                bindTexture(target, texture);
+            }
+
+            void StateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+                const bool tracked = target == GL_UNIFORM_BUFFER && index < kMaxUniformBindings;
+                if (tracked) {
+                    const BufferRange& bound = m_UniformRanges[index];
+                    if (bound.buffer == buffer && bound.offset == offset && bound.size == size) { ++m_Stats.skipped; return; }
+                }
+
+                glBindBufferRange(target, index, buffer, offset, size);
+                ++m_Stats.issued;
+                int slot = FindSlot(kBufferTargetInfo, target);
+                if (slot >= 0) m_Buffers[slot] = buffer;
+                if (!tracked) return;
+                m_UniformRanges[index] = { buffer, offset, size };
+                if (m_Validate) check(GL_UNIFORM_BUFFER_BINDING, buffer, "buffer");
+            }
+
+            void StateCache::onBufferDeleted(GLuint buffer) {
+                for (GLuint& bound : m_Buffers)
+                    if (bound == buffer) bound = 0;
+                for (BufferRange& range : m_UniformRanges)
+                    if (range.buffer == buffer) range = { 0, 0, 0 };
+            }
+
+            void StateCache::onTextureDeleted(GLuint texture) {
+                for (auto& unit : m_Textures)
+                    for (GLuint& bound : unit)
+                        if (bound == texture) bound = 0;
+            }
+
+            void StateCache::onVertexArrayDeleted(GLuint vao) {
+                if (m_VAO == vao) {
+                    m_VAO = 0;
+                    m_Buffers[kElementArraySlot] = kUnknown;
+                }
+            }
+
+            bool StateCache::check(GLenum pname, GLuint expected, const char* what) const {
+                if (expected == kUnknown) return true;
+                GLint actual = 0;
+                glGetIntegerv(pname, &actual);
+                if (static_cast<GLuint>(actual) == expected) return true;
+                std::cerr << "StateCache: " << what << " binding mismatch, cached " << expected
+                          << " but GL has " << actual << "\n";
+                return false;
+            }
+
+            bool StateCache::validate() const {
+                bool ok = check(GL_CURRENT_PROGRAM, m_Program, "program");
+                ok &= check(GL_VERTEX_ARRAY_BINDING, m_VAO, "vertex array");
+                for (int slot = 0; slot < kBufferTargets; ++slot) {
+                    if (kBufferTargetInfo[slot].target != 0)
+                        ok &= check(kBufferTargetInfo[slot].bindingQuery, m_Buffers[slot], "buffer");
+                }
+                if (m_ActiveUnit != kUnknown)
+                    ok &= check(GL_ACTIVE_TEXTURE, GL_TEXTURE0 + m_ActiveUnit, "active texture");
+                for (GLuint index = 0; index < kMaxUniformBindings; ++index) {
+                    if (m_UniformRanges[index].buffer == kUnknown) continue;
+                    GLint actual = 0;
+                    glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, index, &actual);
+                    if (static_cast<GLuint>(actual) != m_UniformRanges[index].buffer) {
+                        std::cerr << "StateCache: uniform buffer binding " << index << " mismatch, cached "
+                                  << m_UniformRanges[index].buffer << " but GL has " << actual << "\n";
+                        ok = false;
+                    }
+                }
+
+                // Per-unit texture bindings can only be queried through the active unit
+                GLint activeUnit = 0;
+                glGetIntegerv(GL_ACTIVE_TEXTURE, &activeUnit);
+                for (GLuint unit = 0; unit < kMaxTextureUnits; ++unit) {
+                    bool known = false;
+                    for (GLuint texture : m_Textures[unit]) known |= texture != kUnknown;
+                    if (!known) continue;
+                    glActiveTexture(GL_TEXTURE0 + unit);
+                    for (int slot = 0; slot < kTextureTargets; ++slot)
+                        ok &= check(kTextureTargetInfo[slot].bindingQuery, m_Textures[unit][slot], "texture");
+                }
+                glActiveTexture(static_cast<GLenum>(activeUnit));
+                return ok;
+            }
+
+        }
+    }
+}
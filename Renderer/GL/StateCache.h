@@ -0,0 +1,95 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <cstddef>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            struct NYX_API StateCacheStats {
+                size_t issued = 0;   // Calls forwarded to GL
+                size_t skipped = 0;  // Calls elided because the state already matched
+            };
+
+            /**
+             * Shadow copy of the binding state of the current GL context. Every Nyx wrapper binds
+             * through it, so redundant glUseProgram / glBindVertexArray / glBindBuffer /
+             * glActiveTexture / glBindTexture calls never reach the driver.
+             *
+             * There is one cache per thread, matching one context current per thread. After making a
+             * different context current, or after changing bindings with raw GL calls, call invalidate().
+             * setValidation(true) checks every cached call against glGet* and reports mismatches.
+             */
+            class NYX_API StateCache {
+            public:
+                static constexpr GLuint kUnknown = 0xFFFFFFFFu;
+                static constexpr GLuint kMaxTextureUnits = 32;
+                static constexpr GLuint kMaxUniformBindings = 36;
+
+                static StateCache& Current();
+
+                void useProgram(GLuint program);
+                void bindVertexArray(GLuint vao);
+                // GL_ELEMENT_ARRAY_BUFFER is VAO state and becomes unknown whenever the VAO changes
+                void bindBuffer(GLenum target, GLuint buffer);
+                void activeTexture(GLuint unit);
+                // Binds on the active unit
+                void bindTexture(GLenum target, GLuint texture);
+                // Activates unit if needed, then binds
+                void bindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+                // Indexed binding; GL_UNIFORM_BUFFER ranges are tracked, other targets always reach GL.
+                // Like GL, this also binds buffer to the generic target.
+                void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+                // GL silently unbinds deleted objects from the current context, the cache has to follow
+                void onBufferDeleted(GLuint buffer);
+                void onTextureDeleted(GLuint texture);
+                void onVertexArrayDeleted(GLuint vao);
+
+                // Forget everything, the next call of each kind always reaches GL
+                void invalidate();
+
+                void setValidation(bool enabled) { m_Validate = enabled; }
+                // Compares every known binding against glGet*, logging mismatches. Returns true if all match.
+                bool validate() const;
+
+                const StateCacheStats& getStats() const { return m_Stats; }
+                void resetStats() { m_Stats = {}; }
+
+            private:
+                StateCache();
+
+                bool check(GLenum pname, GLuint expected, const char* what) const;
+
+            private:
+                static constexpr int kBufferTargets = 9;
+                static constexpr int kTextureTargets = 3;
+
+                GLuint m_Program;
+                GLuint m_VAO;
+                GLuint m_Buffers[kBufferTargets];
+                GLuint m_ActiveUnit;
+                GLuint m_Textures[kMaxTextureUnits][kTextureTargets];
+                struct BufferRange {
+                    GLuint buffer;
+                    GLintptr offset;
+                    GLsizeiptr size;
+                };
+                BufferRange m_UniformRanges[kMaxUniformBindings];
+
+                bool m_Validate = false;
+                StateCacheStats m_Stats;
+            };
+
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#include "StreamBuffer.h"
+#include "StateCache.h"
+#include "GLCaps.h"
+#include <cstring>
+#include <iostream>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                bool IsSignaled(GLsync fence, GLuint64 timeout) {
+                    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+                    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+                }
+            }
+
+            StreamBuffer::StreamBuffer(GLsizeiptr frameSize, GLenum target, unsigned int frameCount)
+                : m_Target(target), m_FrameSize(frameSize), m_FrameCount(frameCount ? frameCount : 1),
+                  m_Fences(m_FrameCount, nullptr)
+            {
+                m_VBO = std::make_unique<VBO>();
+                if (!createPersistent()) {
+                    StateCache::Current().bindBuffer(m_Target, m_VBO->getID());
+                    glBufferData(m_Target, m_FrameSize * m_FrameCount, nullptr, GL_STREAM_DRAW);
+                    m_Shadow.resize(static_cast<size_t>(m_FrameSize));
+                }
+            }
+
+            StreamBuffer::~StreamBuffer() {
+                for (GLsync fence : m_Fences)
+                    if (fence) glDeleteSync(fence);
+                if (m_Mapped) {
+                    StateCache::Current().bindBuffer(m_Target, m_VBO->getID());
+                    glUnmapBuffer(m_Target);
+                }
+            }
+
+            bool StreamBuffer::createPersistent() {
+#ifdef GL_VERSION_4_4
+                if (!GLCaps::Current().bufferStorage) return false;
+
+                const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                const GLsizeiptr size = m_FrameSize * m_FrameCount;
+                StateCache::Current().bindBuffer(m_Target, m_VBO->getID());
+                glBufferStorage(m_Target, size, nullptr, flags);
+                m_Mapped = static_cast<uint8_t*>(glMapBufferRange(m_Target, 0, size, flags));
+                if (m_Mapped) return true;
+
+                // Immutable storage cannot be respecified, start over with a fresh buffer
+                std::cerr << "StreamBuffer: persistent mapping failed, falling back to orphaning\n";
+                m_VBO = std::make_unique<VBO>();
+#endif
+                return false;
+            }
+
+            void StreamBuffer::waitForRegion(unsigned int region) {
+                GLsync& fence = m_Fences[region];
+                if (!fence) return;
+
+                if (!IsSignaled(fence, 0)) {
+                    ++m_Stats.stalls;
+                    if (m_Mapped) {
+                        // Persistent storage cannot be orphaned, the GPU is more than frameCount frames behind
+                        while (!IsSignaled(fence, 1000000)) {}
+                    }
+                    else {
+                        // New storage is not referenced by any pending draw, so every region is free again
+                        StateCache::Current().bindBuffer(m_Target, m_VBO->getID());
+                        glBufferData(m_Target, m_FrameSize * m_FrameCount, nullptr, GL_STREAM_DRAW);
+                        ++m_Stats.orphans;
+                        for (GLsync& pending : m_Fences) {
+                            if (pending) glDeleteSync(pending);
+                            pending = nullptr;
+                        }
+                        return;
+                    }
+                }
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+
+            void StreamBuffer::beginFrame() {
+                if (m_InFrame) endFrame();
+                m_Region = (m_Region + 1) % m_FrameCount;
+                waitForRegion(m_Region);
+                m_Head = 0;
+                m_Flushed = 0;
+                m_InFrame = true;
+            }
+
+            void StreamBuffer::endFrame() {
+                if (!m_InFrame) return;
+                flush();
+                if (m_Fences[m_Region]) glDeleteSync(m_Fences[m_Region]);
+                m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                m_InFrame = false;
+            }
+
+            StreamAllocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+                StreamAllocation allocation;
+                if (!m_InFrame) beginFrame();
+
+                const GLintptr base = static_cast<GLintptr>(m_Region) * m_FrameSize;
+                GLintptr offset = base + m_Head;
+                if (alignment > 1) offset = (offset + alignment - 1) / alignment * alignment;
+                if (size <= 0 || offset - base + size > m_FrameSize) {
+                    ++m_Stats.overflows;
+                    return allocation;
+                }
+
+                // Fallback uploads go through the same span, anything skipped for alignment is uploaded too
+                allocation.data = m_Mapped ? m_Mapped + offset : m_Shadow.data() + (offset - base);
+                allocation.offset = offset;
+                allocation.size = size;
+                m_Head = offset - base + size;
+                m_Stats.bytesWritten += static_cast<size_t>(size);
+                return allocation;
+            }
+
+            StreamAllocation StreamBuffer::write(const void* data, GLsizeiptr size, GLsizeiptr alignment) {
+                StreamAllocation allocation = allocate(size, alignment);
+                if (allocation.isValid()) std::memcpy(allocation.data, data, static_cast<size_t>(size));
+                return allocation;
+            }
+
+            void StreamBuffer::flush() {
+                if (m_Mapped || m_Head == m_Flushed) return;
+
+                const GLintptr base = static_cast<GLintptr>(m_Region) * m_FrameSize;
+                const GLsizeiptr size = m_Head - m_Flushed;
+                StateCache::Current().bindBuffer(m_Target, m_VBO->getID());
+
+                // The range was never handed to a draw since the region was fenced free, so no sync is needed
+                const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+                void* mapped = glMapBufferRange(m_Target, base + m_Flushed, size, access);
+                if (mapped) {
+                    std::memcpy(mapped, m_Shadow.data() + m_Flushed, static_cast<size_t>(size));
+                    glUnmapBuffer(m_Target);
+                }
+                else {
+                    glBufferSubData(m_Target, base + m_Flushed, size, m_Shadow.data() + m_Flushed);
+                }
+                m_Flushed = m_Head;
+            }
+
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "VBO.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            // A span of a StreamBuffer, valid until the end of the frame it was allocated in
+            struct NYX_API StreamAllocation {
+                void* data = nullptr;    // CPU pointer to write to
+                GLintptr offset = 0;     // Byte offset in the GL buffer, for attribute pointers and glBindBufferRange
+                GLsizeiptr size = 0;
+
+                inline bool isValid() const { return data != nullptr; }
+                // First vertex / instance of the span when it holds elements of the given stride
+                inline GLint firstElement(GLsizei stride) const { return static_cast<GLint>(offset / stride); }
+            };
+
+            struct NYX_API StreamBufferStats {
+                size_t bytesWritten = 0;
+                size_t overflows = 0;    // Allocations that did not fit in the frame region
+                size_t stalls = 0;       // Frames that found their region still in use by the GPU
+                size_t orphans = 0;      // Fallback path: stalls resolved by orphaning instead of waiting
+            };
+
+            /**
+             * Ring buffer for data rewritten every frame (particles, debug lines, UI, per-draw uniforms).
+             * The buffer is split into frameCount regions, each guarded by a fence, so the CPU writes one
+             * region while the GPU still reads the previous ones.
+             *
+             * On GL 4.4+ the storage is immutable and persistently mapped (coherent), so allocate()
+             * returns a pointer straight into GPU-visible memory. Older contexts write to a CPU copy that
+             * flush() uploads with an unsynchronized glMapBufferRange; when the GPU falls behind, the
+             * buffer is orphaned instead of waited on.
+             *
+             *   stream.beginFrame();
+             *   StreamAllocation a = stream.write(vertices, bytes, sizeof(Vertex));
+             *   stream.flush();                                   // before drawing from it
+             *   glDrawArrays(GL_LINES, a.firstElement(sizeof(Vertex)), count);
+             *   stream.endFrame();                                // after the last draw using it
+             */
+            class NYX_API StreamBuffer {
+            public:
+                StreamBuffer(GLsizeiptr frameSize, GLenum target = GL_ARRAY_BUFFER, unsigned int frameCount = 3);
+                ~StreamBuffer();
+                StreamBuffer(const StreamBuffer&) = delete;
+                StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+                // Moves to the next region, waiting (persistent) or orphaning (fallback) if the GPU still uses it
+                void beginFrame();
+                // Fences the region so it is not reused before the GPU is done with it
+                void endFrame();
+
+                // Returns an invalid allocation if the frame region is full. The buffer offset is rounded up
+                // to a multiple of alignment, pass the vertex stride to use firstElement().
+                StreamAllocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+                StreamAllocation write(const void* data, GLsizeiptr size, GLsizeiptr alignment = 16);
+                // Makes everything written since the last flush visible to GL. No-op for persistent buffers.
+                void flush();
+
+                // The underlying buffer, e.g. for VAO::addVBO. Attribute offsets are relative to the
+                // buffer start, use StreamAllocation::offset / firstElement to reach a span.
+                inline VBO* getVBO() const { return m_VBO.get(); }
+                inline GLuint getID() const { return m_VBO->getID(); }
+                inline GLenum getTarget() const { return m_Target; }
+                inline GLsizeiptr getFrameSize() const { return m_FrameSize; }
+                inline bool isPersistent() const { return m_Mapped != nullptr; }
+
+                inline const StreamBufferStats& getStats() const { return m_Stats; }
+                void resetStats() { m_Stats = {}; }
+
+            private:
+                bool createPersistent();
+                void waitForRegion(unsigned int region);
+
+            private:
+                GLenum m_Target;
+                GLsizeiptr m_FrameSize;
+                unsigned int m_FrameCount;
+                std::unique_ptr<VBO> m_VBO;
+
+                uint8_t* m_Mapped = nullptr;        // Persistent mapping of the whole buffer
+                std::vector<uint8_t> m_Shadow;      // Fallback: CPU copy of the current region
+
+                std::vector<GLsync> m_Fences;
+                unsigned int m_Region = 0;
+                GLsizeiptr m_Head = 0;              // Next free byte in the current region
+                GLsizeiptr m_Flushed = 0;           // Fallback: bytes of the region already uploaded
+                bool m_InFrame = false;
+
+                StreamBufferStats m_Stats;
+            };
+
+        }
+    }
+}
@@ -1,5 +1,7 @@
 // Nyx/Renderer/GL/Texture2D.cpp
 #include "Texture2D.h"
+#include "StateCache.h"
+#include "GLCaps.h"
 
 
 
@@ -12,32 +14,175 @@ namespace Nyx {
 
             Texture2D::~Texture2D() {
                 glDeleteTextures(1, &m_TextureID);
+                StateCache::Current().onTextureDeleted(m_TextureID);
             }
             void Texture2D::setTextureParams(const TextureParams& params) {
-                glBindTexture(GL_TEXTURE_2D, m_TextureID);
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, m_TextureID);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrapS);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrapT);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.minFilter);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.magFilter);
             }
-            void Texture2D::setData(int width, int height, int channels, const void* data) {
+            bool Texture2D::setData(int width, int height, int channels, const void* data) {
                 GLenum format = GL_RGB;
                 if (channels == 4) format = GL_RGBA;
-                glBindTexture(GL_TEXTURE_2D, m_TextureID);
-                glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, m_TextureID);
+                if (m_HasStorage) {
+                    // Immutable storage cannot be respecified, only overwritten
+                    if (width != m_Width || height != m_Height) {
+                        std::cerr << "Texture2D: setData size does not match the allocated storage\n";
+                        return false;
+                    }
+                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+                }
+                else {
+                    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+                    m_Width = width;
+                    m_Height = height;
+                    m_Levels = MipLevelCount(width, height);
+                    m_InternalFormat = format;
+                }
+                glGenerateMipmap(GL_TEXTURE_2D);
+                return true;
+            }
+
+            int Texture2D::MipLevelCount(int width, int height) {
+                int levels = 1;
+                for (int size = width > height ? width : height; size > 1; size >>= 1) ++levels;
+                return levels;
+            }
+
+            GLenum Texture2D::FormatForChannels(int channels) {
+                switch (channels) {
+                case 1: return GL_RED;
+                case 2: return GL_RG;
+                case 3: return GL_RGB;
+                default: return GL_RGBA;
+                }
+            }
+
+            GLenum Texture2D::InternalFormatForChannels(int channels) {
+                switch (channels) {
+                case 1: return GL_R8;
+                case 2: return GL_RG8;
+                case 3: return GL_RGB8;
+                default: return GL_RGBA8;
+                }
+            }
+
+            GLsizei Texture2D::CompressedBlockBytes(GLenum internalFormat) {
+                switch (internalFormat) {
+                case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+                case GL_COMPRESSED_RED_RGTC1:
+                    return 8;
+                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+                case GL_COMPRESSED_RG_RGTC2:
+                case GL_COMPRESSED_RGBA_BPTC_UNORM:
+                case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+                    return 16;
+                default:
+                    return 0;
+                }
+            }
+
+            size_t Texture2D::CompressedLevelSize(GLenum internalFormat, int width, int height) {
+                size_t blocksX = (size_t(width > 0 ? width : 1) + 3) / 4;
+                size_t blocksY = (size_t(height > 0 ? height : 1) + 3) / 4;
+                return blocksX * blocksY * size_t(CompressedBlockBytes(internalFormat));
+            }
+
+            bool Texture2D::allocateStorage(int width, int height, GLenum internalFormat, int levels) {
+                if (m_HasStorage) {
+                    std::cerr << "Texture2D: storage is immutable and already allocated\n";
+                    return false;
+                }
+                if (width <= 0 || height <= 0) {
+                    std::cerr << "Texture2D: cannot allocate " << width << "x" << height << " storage\n";
+                    return false;
+                }
+                const int maxLevels = MipLevelCount(width, height);
+                if (levels <= 0 || levels > maxLevels) levels = maxLevels;
+
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, m_TextureID);
+#ifdef GL_VERSION_4_2
+                if (GLCaps::Current().textureStorage) {
+                    glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+                    m_HasStorage = true;
+                }
+#endif
+                if (!m_HasStorage) {
+                    // Same result through mutable storage: every level defined up front, the rest excluded
+                    const bool compressed = CompressedBlockBytes(internalFormat) != 0;
+                    for (int level = 0; level < levels; ++level) {
+                        int levelWidth = width >> level, levelHeight = height >> level;
+                        if (levelWidth < 1) levelWidth = 1;
+                        if (levelHeight < 1) levelHeight = 1;
+                        if (compressed) {
+                            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, levelWidth, levelHeight, 0,
+                                                   static_cast<GLsizei>(CompressedLevelSize(internalFormat, levelWidth, levelHeight)), nullptr);
+                        }
+                        else {
+                            glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(internalFormat), levelWidth, levelHeight,
+                                         0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                        }
+                    }
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+                    m_HasStorage = true;
+                }
+                m_Width = width;
+                m_Height = height;
+                m_Levels = levels;
+                m_InternalFormat = internalFormat;
+                return true;
+            }
+
+            void Texture2D::setSubData(int level, int x, int y, int width, int height, GLenum format, GLenum type, const void* pixels) {
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, m_TextureID);
+                glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, format, type, pixels);
+            }
+
+            bool Texture2D::setCompressedData(int level, int width, int height, GLenum internalFormat, const void* data, GLsizei size) {
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, m_TextureID);
+                if (m_HasStorage) {
+                    if (internalFormat != m_InternalFormat || level >= m_Levels) {
+                        std::cerr << "Texture2D: compressed data does not match the allocated storage\n";
+                        return false;
+                    }
+                    glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, internalFormat, size, data);
+                    return true;
+                }
+
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, size, data);
+                if (level == 0) {
+                    m_Width = width;
+                    m_Height = height;
+                    m_InternalFormat = internalFormat;
+                    m_Levels = 1;
+                }
+                else if (level >= m_Levels) {
+                    m_Levels = level + 1;
+                }
+                // Levels past the uploaded ones would leave the texture incomplete
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_Levels - 1);
+                return true;
+            }
+
+            void Texture2D::generateMipmaps() {
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, m_TextureID);
                 glGenerateMipmap(GL_TEXTURE_2D);
             }
 
             void Texture2D::ActivateTextureAtSlot(unsigned int slot) {
-                glActiveTexture(GL_TEXTURE0 + slot);
-                glBindTexture(GL_TEXTURE_2D, m_TextureID);
+                StateCache::Current().bindTextureUnit(slot, GL_TEXTURE_2D, m_TextureID);
             }            
             void Texture2D::bind(){
-                glBindTexture(GL_TEXTURE_2D, m_TextureID);
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, m_TextureID);
             }
 
             void Texture2D::unbind() {
-                glBindTexture(GL_TEXTURE_2D, 0);
+                StateCache::Current().bindTexture(GL_TEXTURE_2D, 0);
             }
 
         }
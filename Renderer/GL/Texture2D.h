@@ -11,8 +11,35 @@
 #endif
 
 
+#include <cstddef>
 #include <iostream>
 
+// Block compressed formats. S3TC is an extension and some loaders leave it out of the core headers.
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RED_RGTC1
+#define GL_COMPRESSED_RED_RGTC1 0x8DBB
+#endif
+#ifndef GL_COMPRESSED_RG_RGTC2
+#define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
 namespace Nyx {
     namespace Renderer {
         namespace GL {
@@ -30,7 +57,28 @@ namespace Nyx {
 
                 // Upload pixel data to GPU (expects raw RGBA/RGB data)
                 void setTextureParams(const TextureParams& params = {});
-                void setData(int width, int height, int channels, const void* data);
+                // Returns false when the texture has immutable storage of a different size
+                bool setData(int width, int height, int channels, const void* data);
+
+                // Immutable storage (glTexStorage2D on GL 4.2+, one glTexImage2D per level before that).
+                // levels = 0 allocates the full mip chain. Data then goes in with setSubData.
+                // Returns false when storage is already allocated or the size is empty.
+                bool allocateStorage(int width, int height, GLenum internalFormat = GL_RGBA8, int levels = 0);
+                // pixels is an offset when a GL_PIXEL_UNPACK_BUFFER is bound
+                void setSubData(int level, int x, int y, int width, int height, GLenum format, GLenum type, const void* pixels);
+                void generateMipmaps();
+                // One level of block compressed data (size bytes). Goes through glCompressedTexSubImage2D
+                // when storage is allocated, otherwise defines the level. Returns false when the format
+                // or level does not fit the allocated storage.
+                bool setCompressedData(int level, int width, int height, GLenum internalFormat, const void* data, GLsizei size);
+
+                static int MipLevelCount(int width, int height);
+                // GL_RED / GL_RG / GL_RGB / GL_RGBA and the matching 8-bit internal format
+                static GLenum FormatForChannels(int channels);
+                static GLenum InternalFormatForChannels(int channels);
+                // Bytes per 4x4 block of a compressed format, 0 for uncompressed formats
+                static GLsizei CompressedBlockBytes(GLenum internalFormat);
+                static size_t CompressedLevelSize(GLenum internalFormat, int width, int height);
                 // Bind to a texture unit (GL_TEXTURE0 + slot)
                 void bind();
                 void unbind();
@@ -38,8 +86,18 @@ namespace Nyx {
 
                 // Get OpenGL texture ID (if needed externally)
                 GLuint id() const { return m_TextureID; }
+                int getWidth() const { return m_Width; }
+                int getHeight() const { return m_Height; }
+                int getLevels() const { return m_Levels; }
+                GLenum getInternalFormat() const { return m_InternalFormat; }
+                bool hasStorage() const { return m_HasStorage; }
             private:
                 GLuint m_TextureID = 0;
+                int m_Width = 0;
+                int m_Height = 0;
+                int m_Levels = 0;
+                GLenum m_InternalFormat = 0;
+                bool m_HasStorage = false;   // Allocated with allocateStorage, glTexImage2D no longer allowed
             };
 
         }
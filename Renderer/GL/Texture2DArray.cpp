@@ -0,0 +1,115 @@
+#include "Texture2DArray.h"
+#include "StateCache.h"
+#include "GLCaps.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+            Texture2DArray::Texture2DArray() {
+                glGenTextures(1, &m_TextureID);
+            }
+
+            Texture2DArray::~Texture2DArray() {
+                glDeleteTextures(1, &m_TextureID);
+                StateCache::Current().onTextureDeleted(m_TextureID);
+            }
+
+            int Texture2DArray::MaxLayers() {
+                thread_local GLint layers = 0;
+                if (layers == 0) glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &layers);
+                return layers > 0 ? layers : 256;
+            }
+
+            bool Texture2DArray::allocateStorage(int width, int height, int layers, GLenum internalFormat, int levels) {
+                if (m_HasStorage) {
+                    std::cerr << "Texture2DArray: storage is immutable and already allocated\n";
+                    return false;
+                }
+                if (width <= 0 || height <= 0 || layers <= 0) {
+                    std::cerr << "Texture2DArray: cannot allocate " << width << "x" << height << "x" << layers << " storage\n";
+                    return false;
+                }
+                const int maxLevels = Texture2D::MipLevelCount(width, height);
+                if (levels <= 0 || levels > maxLevels) levels = maxLevels;
+
+                StateCache::Current().bindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+#ifdef GL_VERSION_4_2
+                if (GLCaps::Current().textureStorage) {
+                    glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, internalFormat, width, height, layers);
+                    m_HasStorage = true;
+                }
+#endif
+                if (!m_HasStorage) {
+                    const bool compressed = Texture2D::CompressedBlockBytes(internalFormat) != 0;
+                    for (int level = 0; level < levels; ++level) {
+                        int levelWidth = width >> level, levelHeight = height >> level;
+                        if (levelWidth < 1) levelWidth = 1;
+                        if (levelHeight < 1) levelHeight = 1;
+                        if (compressed) {
+                            GLsizei size = static_cast<GLsizei>(Texture2D::CompressedLevelSize(internalFormat, levelWidth, levelHeight) * size_t(layers));
+                            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, levelWidth, levelHeight, layers, 0, size, nullptr);
+                        }
+                        else {
+                            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, static_cast<GLint>(internalFormat), levelWidth, levelHeight, layers,
+                                         0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                        }
+                    }
+                    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+                    m_HasStorage = true;
+                }
+                m_Width = width;
+                m_Height = height;
+                m_Layers = layers;
+                m_Levels = levels;
+                m_InternalFormat = internalFormat;
+                return true;
+            }
+
+            bool Texture2DArray::setLayerData(int layer, int level, int width, int height, GLenum format, GLenum type, const void* pixels) {
+                if (layer >= m_Layers || level >= m_Levels) {
+                    std::cerr << "Texture2DArray: layer " << layer << " level " << level << " is outside the storage\n";
+                    return false;
+                }
+                StateCache::Current().bindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, format, type, pixels);
+                return true;
+            }
+
+            bool Texture2DArray::setCompressedLayerData(int layer, int level, int width, int height, const void* data, GLsizei size) {
+                if (layer >= m_Layers || level >= m_Levels) {
+                    std::cerr << "Texture2DArray: layer " << layer << " level " << level << " is outside the storage\n";
+                    return false;
+                }
+                StateCache::Current().bindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, m_InternalFormat, size, data);
+                return true;
+            }
+
+            void Texture2DArray::generateMipmaps() {
+                StateCache::Current().bindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+                glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            }
+
+            void Texture2DArray::setTextureParams(const TextureParams& params) {
+                StateCache::Current().bindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, params.wrapS);
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, params.wrapT);
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, params.minFilter);
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, params.magFilter);
+            }
+
+            void Texture2DArray::bind() {
+                StateCache::Current().bindTexture(GL_TEXTURE_2D_ARRAY, m_TextureID);
+            }
+
+            void Texture2DArray::unbind() {
+                StateCache::Current().bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            }
+
+            void Texture2DArray::ActivateTextureAtSlot(unsigned int slot) {
+                StateCache::Current().bindTextureUnit(slot, GL_TEXTURE_2D_ARRAY, m_TextureID);
+            }
+
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <iostream>
+#include "Texture2D.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            // GL_TEXTURE_2D_ARRAY: layers of one size and format behind a single binding.
+            // Shaders sample it with a sampler2DArray and vec3(uv, layer).
+            class NYX_API Texture2DArray {
+            public:
+                Texture2DArray();
+                ~Texture2DArray();
+                Texture2DArray(const Texture2DArray&) = delete;
+                Texture2DArray& operator=(const Texture2DArray&) = delete;
+
+                // Immutable storage (glTexStorage3D on GL 4.2+, one glTexImage3D per level before that).
+                // levels = 0 allocates the full mip chain. Returns false when storage is already allocated
+                // or the size is empty.
+                bool allocateStorage(int width, int height, int layers, GLenum internalFormat = GL_RGBA8, int levels = 0);
+                // pixels is an offset when a GL_PIXEL_UNPACK_BUFFER is bound. Both return false for a layer
+                // or level outside the storage.
+                bool setLayerData(int layer, int level, int width, int height, GLenum format, GLenum type, const void* pixels);
+                bool setCompressedLayerData(int layer, int level, int width, int height, const void* data, GLsizei size);
+                void generateMipmaps();
+
+                void setTextureParams(const TextureParams& params = {});
+                void bind();
+                void unbind();
+                void ActivateTextureAtSlot(unsigned int slot);
+
+                GLuint id() const { return m_TextureID; }
+                int getWidth() const { return m_Width; }
+                int getHeight() const { return m_Height; }
+                int getLayers() const { return m_Layers; }
+                int getLevels() const { return m_Levels; }
+                GLenum getInternalFormat() const { return m_InternalFormat; }
+                bool hasStorage() const { return m_HasStorage; }
+
+                // GL_MAX_ARRAY_TEXTURE_LAYERS (at least 256 on GL 3.3)
+                static int MaxLayers();
+
+            private:
+                GLuint m_TextureID = 0;
+                int m_Width = 0;
+                int m_Height = 0;
+                int m_Layers = 0;
+                int m_Levels = 0;
+                GLenum m_InternalFormat = 0;
+                bool m_HasStorage = false;
+            };
+
+        }
+    }
+}
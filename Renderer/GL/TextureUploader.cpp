@@ -0,0 +1,107 @@
+#include "TextureUploader.h"
+#include "StateCache.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            TextureUploader::TextureUploader(GLsizeiptr frameSize, unsigned int frameCount)
+                : m_Staging(frameSize, GL_PIXEL_UNPACK_BUFFER, frameCount)
+            {
+                // A bound unpack buffer turns every client-memory glTexImage2D pointer into an offset
+                StateCache::Current().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+
+            bool TextureUploader::upload(Texture2D& texture, int width, int height, int channels,
+                                         std::vector<unsigned char> pixels, bool generateMipmaps) {
+                if (width <= 0 || height <= 0 || pixels.size() < size_t(width) * size_t(height) * size_t(channels)) {
+                    std::cerr << "TextureUploader: pixel data does not match " << width << "x" << height << "x" << channels << "\n";
+                    return false;
+                }
+
+                const bool matches = texture.hasStorage() && texture.getWidth() == width && texture.getHeight() == height;
+                if (!matches) {
+                    // Immutable storage of another size cannot be replaced, rows would land outside it
+                    int levels = generateMipmaps ? 0 : 1;
+                    if (!texture.allocateStorage(width, height, Texture2D::InternalFormatForChannels(channels), levels))
+                        return false;
+                }
+
+                UploadJob job{ &texture, width, height, channels, std::move(pixels), generateMipmaps };
+                m_Stats.pendingBytes += job.pixels.size();
+                m_Jobs.push_back(std::move(job));
+                m_Stats.pendingTextures = m_Jobs.size();
+                return true;
+            }
+
+            size_t TextureUploader::uploadRows(UploadJob& job, size_t byteLimit, bool force) {
+                const size_t rowBytes = size_t(job.width) * size_t(job.channels);
+                const unsigned char* source = job.pixels.data() + size_t(job.rowsDone) * rowBytes;
+                const GLenum format = Texture2D::FormatForChannels(job.channels);
+
+                // Never ask for more than a frame region holds, or a large budget would overflow every frame
+                const size_t limit = std::min(byteLimit, static_cast<size_t>(m_Staging.getFrameSize()));
+                int rows = static_cast<int>(std::min<size_t>(job.height - job.rowsDone, limit / rowBytes));
+                if (rows == 0 && force) rows = 1;
+                if (rows == 0) return 0;
+
+                StreamAllocation span = m_Staging.write(source, static_cast<GLsizeiptr>(rows * rowBytes), 4);
+                if (span.isValid()) {
+                    m_Staging.flush();
+                    StateCache::Current().bindBuffer(GL_PIXEL_UNPACK_BUFFER, m_Staging.getID());
+                    job.texture->setSubData(0, 0, job.rowsDone, job.width, rows, format, GL_UNSIGNED_BYTE,
+                                            reinterpret_cast<const void*>(static_cast<uintptr_t>(span.offset)));
+                }
+                else if (rowBytes > static_cast<size_t>(m_Staging.getFrameSize())) {
+                    // A single row does not fit in the ring, this texture can only go out directly
+                    StateCache::Current().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    job.texture->setSubData(0, 0, job.rowsDone, job.width, rows, format, GL_UNSIGNED_BYTE, source);
+                    ++m_Stats.directUploads;
+                }
+                else {
+                    return 0;
+                }
+
+                job.rowsDone += rows;
+                return size_t(rows) * rowBytes;
+            }
+
+            size_t TextureUploader::process(size_t byteBudget) {
+                m_Stats.bytesUploaded = 0;
+                m_Stats.texturesCompleted = 0;
+                if (m_Jobs.empty()) return 0;
+
+                m_Staging.beginFrame();
+                // Rows are tightly packed in the ring
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+                size_t uploaded = 0;
+                while (!m_Jobs.empty()) {
+                    UploadJob& job = m_Jobs.front();
+                    size_t remaining = byteBudget > uploaded ? byteBudget - uploaded : 0;
+                    size_t bytes = uploadRows(job, remaining, uploaded == 0);
+                    if (bytes == 0) break;
+                    uploaded += bytes;
+
+                    if (job.rowsDone < job.height) continue;
+                    if (job.generateMipmaps && job.texture->getLevels() > 1) job.texture->generateMipmaps();
+                    m_Stats.pendingBytes -= job.pixels.size();
+                    ++m_Stats.texturesCompleted;
+                    m_Jobs.pop_front();
+                }
+
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+                StateCache::Current().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                m_Staging.endFrame();
+
+                m_Stats.bytesUploaded = uploaded;
+                m_Stats.pendingTextures = m_Jobs.size();
+                return uploaded;
+            }
+
+        }
+    }
+}
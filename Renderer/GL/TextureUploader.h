@@ -0,0 +1,84 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "StreamBuffer.h"
+#include "Texture2D.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            struct NYX_API TextureUploadStats {
+                size_t bytesUploaded = 0;     // During the last process()
+                size_t texturesCompleted = 0; // During the last process()
+                size_t pendingTextures = 0;
+                size_t pendingBytes = 0;
+                size_t directUploads = 0;     // Rows too wide for the staging ring, uploaded from client memory
+            };
+
+            /**
+             * Streams texture data through a ring of pixel-unpack buffers (a StreamBuffer), so uploads
+             * never stall the frame on glTexImage2D from client memory. Textures get immutable storage
+             * with the full mip chain when queued; process() then copies at most a byte budget of rows
+             * per frame into the ring and issues glTexSubImage2D from it. Large images spread over
+             * several frames, and fences keep the ring from overwriting rows the GPU has not read yet.
+             *
+             *   TextureUploader uploader;
+             *   uploader.upload(texture, width, height, channels, std::move(pixels));
+             *   // every frame, on the GL thread:
+             *   uploader.process(4 * 1024 * 1024);
+             *
+             * Queued textures must outlive their upload. Until then they hold undefined contents.
+             */
+            class NYX_API TextureUploader {
+            public:
+                // frameSize is the staging space per frame, and so the largest useful budget
+                TextureUploader(GLsizeiptr frameSize = 8 * 1024 * 1024, unsigned int frameCount = 3);
+
+                // Allocates the texture's storage (unless it already matches) and queues level 0.
+                // Mipmaps are generated once the last row has been uploaded. Returns false, and queues
+                // nothing, when the pixels do not match the size or the storage cannot be allocated.
+                bool upload(Texture2D& texture, int width, int height, int channels,
+                            std::vector<unsigned char> pixels, bool generateMipmaps = true);
+
+                // Uploads up to byteBudget bytes of queued rows; at least one row goes out per call so
+                // progress is guaranteed. Returns the number of bytes uploaded.
+                size_t process(size_t byteBudget);
+
+                inline bool hasPendingUploads() const { return !m_Jobs.empty(); }
+                inline const TextureUploadStats& getStats() const { return m_Stats; }
+
+            private:
+                struct UploadJob {
+                    Texture2D* texture;
+                    int width;
+                    int height;
+                    int channels;
+                    std::vector<unsigned char> pixels;
+                    bool generateMipmaps;
+                    int rowsDone = 0;
+                };
+
+                // Returns bytes uploaded, or 0 if the ring is full for this frame
+                size_t uploadRows(UploadJob& job, size_t byteLimit, bool force);
+
+            private:
+                StreamBuffer m_Staging;
+                std::deque<UploadJob> m_Jobs;
+                TextureUploadStats m_Stats;
+            };
+
+        }
+    }
+}
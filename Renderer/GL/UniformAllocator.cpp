@@ -0,0 +1,30 @@
+#include "UniformAllocator.h"
+#include "StateCache.h"
+#include <algorithm>
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            namespace {
+                GLsizeiptr QueryOffsetAlignment() {
+                    GLint alignment = 0;
+                    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+                    // std140 blocks need at least vec4 alignment
+                    return std::max<GLsizeiptr>(alignment, 16);
+                }
+            }
+
+            UniformAllocator::UniformAllocator(GLsizeiptr frameSize, unsigned int frameCount)
+                : m_Stream(frameSize, GL_UNIFORM_BUFFER, frameCount),
+                  m_Alignment(QueryOffsetAlignment())
+            {}
+
+            void UniformAllocator::bind(GLuint bindingPoint, const StreamAllocation& block) const {
+                if (!block.isValid()) return;
+                StateCache::Current().bindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_Stream.getID(), block.offset, block.size);
+            }
+
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifdef NYX_USE_GLAD
+#include <glad/glad.h>
+#include "../../NyxAPI.h"
+#elif defined(NYX_USE_GLEW)
+#include <GL/glew.h>
+#else
+#error "No OpenGL loader defined. Define NYX_USE_GLAD or NYX_USE_GLEW before including Nyx headers."
+#endif
+
+#include "StreamBuffer.h"
+
+namespace Nyx {
+    namespace Renderer {
+        namespace GL {
+
+            /**
+             * Frame-scoped storage for uniform blocks. Per-draw and per-material blocks are packed into
+             * one StreamBuffer at GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT and bound with glBindBufferRange, so
+             * setting a draw's uniforms costs a pointer bump, a memcpy and (at most) one bind.
+             *
+             * Block structs must follow std140: vec3 padded to 16 bytes, arrays and mat4 columns on
+             * 16-byte strides.
+             *
+             *   struct alignas(16) ObjectBlock { float model[16]; float tint[4]; };   // uniform Object { ... };
+             *   shader.setUniformBlockBinding("Object", 1);
+             *
+             *   uniforms.beginFrame();
+             *   StreamAllocation block = uniforms.push(ObjectBlock{ ... });
+             *   uniforms.flush();                 // before the draws
+             *   uniforms.bind(1, block);
+             *   ...draw...
+             *   uniforms.endFrame();
+             */
+            class NYX_API UniformAllocator {
+            public:
+                UniformAllocator(GLsizeiptr frameSize = 1 << 20, unsigned int frameCount = 3);
+
+                void beginFrame() { m_Stream.beginFrame(); }
+                void endFrame() { m_Stream.endFrame(); }
+                void flush() { m_Stream.flush(); }
+
+                // Returns an invalid allocation if the frame's space is exhausted
+                StreamAllocation push(const void* data, GLsizeiptr size) { return m_Stream.write(data, size, m_Alignment); }
+                template<typename Block>
+                StreamAllocation push(const Block& block) { return push(&block, sizeof(Block)); }
+
+                // glBindBufferRange through the state cache, skipped if the range is already bound
+                void bind(GLuint bindingPoint, const StreamAllocation& block) const;
+
+                inline GLuint getID() const { return m_Stream.getID(); }
+                inline GLsizeiptr getAlignment() const { return m_Alignment; }
+                inline const StreamBufferStats& getStats() const { return m_Stream.getStats(); }
+
+            private:
+                StreamBuffer m_Stream;
+                GLsizeiptr m_Alignment;
+            };
+
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "VAO.h"
+#include "StateCache.h"
 
 
 namespace Nyx
@@ -15,14 +16,15 @@ namespace Nyx
 			VAO::~VAO()
 			{
 				glDeleteVertexArrays(1, &m_VAO);
+				StateCache::Current().onVertexArrayDeleted(m_VAO);
 			}
 			void VAO::bind() const
 			{
-				glBindVertexArray(m_VAO);
+				StateCache::Current().bindVertexArray(m_VAO);
 			}
 			void VAO::unbind() const
 			{
-				glBindVertexArray(0);
+				StateCache::Current().bindVertexArray(0);
 			}
 			void VAO::addVBO(VBO* vbo)
 			{
@@ -30,6 +32,8 @@ namespace Nyx
 			}
 			void VAO::setLayout(const std::vector<VertexAttribute>& layout)
 			{
+				// The VAO stays bound afterwards, every Nyx bind goes through the StateCache so
+				// nothing attaches to it by accident
 				this->bind(); 
 
 				for (const auto& attr : layout) {
@@ -43,10 +47,10 @@ namespace Nyx
 						attr.stride,
 						reinterpret_cast<const void*>(attr.offset)
 					);
-					(m_VBO[attr.vboIndex])->unbind();
+					glVertexAttribDivisor(attr.index, attr.divisor);
+					if (attr.index < 32)
+						m_AttributeMask |= 1u << attr.index;
 				}
-
-				this->unbind();
 			}
 			void VAO::attachIndexBuffer(IBO* ibo)
 			{
@@ -54,8 +58,6 @@ namespace Nyx
 				ibo->bind();   
 				m_IBO = ibo;
 				m_HIBO = true;
-				this->unbind(); 
-				ibo->unbind();
 			}
 			IBO* VAO::getIBO() {
 				if (m_HIBO)
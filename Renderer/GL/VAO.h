@@ -1,6 +1,8 @@
 #pragma once
 #include "VBO.h"
 #include "IBO.h"
+#include "../../Geometry/Bounds.h"
+#include <cstdint>
 #include <vector>
 
 
@@ -28,6 +30,7 @@ namespace Nyx
 				GLsizei stride;     // full vertex size
 				size_t offset;      // offset to this attribute
 				GLuint vboIndex=0;
+				GLuint divisor=0;   // 0 = per vertex, n = advance once every n instances
 			};
 
 
@@ -40,6 +43,9 @@ namespace Nyx
 				IBO* m_IBO;
 				bool m_HIBO = false;
 				size_t m_TotalVertices;
+				Geometry::Bounds m_Bounds;
+				bool m_HasBounds = false;
+				uint32_t m_AttributeMask = 0;
 			public:
 				VAO(size_t totalVertices);
 				~VAO();
@@ -54,6 +60,13 @@ namespace Nyx
 				inline bool hasIBO() { return m_HIBO;  }
 				inline VBO* getVBO(GLuint index) { return m_VBO[index]; }
 				inline size_t getTotalVertices() const { return m_TotalVertices; }
+				// Bit i is set when setLayout() enabled attribute location i
+				inline uint32_t getAttributeMask() const { return m_AttributeMask; }
+
+				// Local-space bounds, moved to world space per draw by Renderer::draw(DrawCommand*) for culling
+				inline void setBounds(const Geometry::Bounds& bounds) { m_Bounds = bounds; m_HasBounds = true; }
+				inline const Geometry::Bounds& getBounds() const { return m_Bounds; }
+				inline bool hasBounds() const { return m_HasBounds; }
 			
 			};
 
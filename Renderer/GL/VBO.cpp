@@ -1,4 +1,5 @@
 #include "VBO.h"
+#include "StateCache.h"
 
 
 
@@ -15,20 +16,25 @@ namespace Nyx
 			VBO::~VBO()
 			{
 				glDeleteBuffers(1, &m_VBO);
+				StateCache::Current().onBufferDeleted(m_VBO);
 			}
 			void VBO::data(const void* data, GLsizeiptr size , GLenum usage)
 			{
 				this->bind();
 				glBufferData(GL_ARRAY_BUFFER, size, data, usage);
-				this->unbind();
+			}
+			void VBO::subData(GLintptr offset, const void* data, GLsizeiptr size)
+			{
+				this->bind();
+				glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
 			}
 			void VBO::bind() const
 			{ 
-				glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+				StateCache::Current().bindBuffer(GL_ARRAY_BUFFER, m_VBO);
 			}
 			void VBO::unbind() const
 			{
-				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				StateCache::Current().bindBuffer(GL_ARRAY_BUFFER, 0);
 			}
 		}
 	}
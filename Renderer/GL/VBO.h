@@ -29,6 +29,7 @@ namespace Nyx
 				void bind() const;
 				void unbind() const;
 				void data(const void* data, GLsizeiptr size, GLenum usage = GL_STATIC_DRAW);
+				void subData(GLintptr offset, const void* data, GLsizeiptr size);
 				inline GLuint getID() const { return m_VBO; }
 			};
 		
@@ -0,0 +1,333 @@
+#include "ResourceManager.h"
+#include "../Core/Hash.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+namespace Nyx
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::string MakeKey(const char* type, const std::string& paths, uint64_t options)
+        {
+            char suffix[24];
+            std::snprintf(suffix, sizeof(suffix), "#%016llx", static_cast<unsigned long long>(options));
+            return std::string(type) + ":" + paths + suffix;
+        }
+
+        uint64_t HashShaderConfig(const Renderer::GL::ShaderConfig& config)
+        {
+            // Only the defines change the program; the cache settings do not
+            uint64_t hash = Core::kFNVOffsetBasis;
+            for (const Renderer::GL::ShaderDefine& define : config.defines)
+            {
+                hash = Core::HashString(define.name, hash);
+                hash = Core::HashString("=", hash);
+                hash = Core::HashString(define.value, hash);
+                hash = Core::HashString("\n", hash);
+            }
+            return hash;
+        }
+
+        // The arena stays allocated at its import size, including the gaps left when optimizations
+        // shrink a mesh, so it is counted whole rather than summed over the mesh views
+        size_t ModelCpuBytes(const Model& model)
+        {
+            size_t bytes = model.GetArena().sizeBytes();
+            for (const Mesh& mesh : model.GetMeshes())
+            {
+                for (const MeshLOD& lod : mesh.lods)
+                    bytes += lod.indices.size() * sizeof(unsigned int);
+            }
+            return bytes;
+        }
+
+        // LoadAsComplete uploads the whole arena, gaps included. AsyncModelLoader's per-mesh buffers
+        // never exceed it, so the arena size holds for both upload paths.
+        size_t ModelGpuBytes(const Model& model)
+        {
+            return model.GetArena().sizeBytes();
+        }
+    }
+
+    ResourceManager::ResourceManager(const ResourceBudget& budget, Core::ThreadPool& pool)
+        : m_Budget(budget), m_Pool(pool), m_ModelLoader(pool)
+    {}
+
+    std::string ResourceManager::CanonicalPath(const std::string& path)
+    {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+        if (ec)
+            canonical = std::filesystem::absolute(path, ec).lexically_normal();
+        return ec ? path : canonical.generic_string();
+    }
+
+    std::shared_ptr<ResourceBase> ResourceManager::find(const std::string& key)
+    {
+        ++m_Stats.requests;
+        auto it = m_Lookup.find(key);
+        if (it == m_Lookup.end())
+            return nullptr;
+
+        m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+        const std::shared_ptr<ResourceBase>& resource = *it->second;
+        if (resource->getState() == ResourceState::Loading)
+            ++m_Stats.coalesced;
+        else
+            ++m_Stats.hits;
+        return resource;
+    }
+
+    void ResourceManager::insert(const std::shared_ptr<ResourceBase>& resource)
+    {
+        m_Entries.push_front(resource);
+        m_Lookup.emplace(resource->m_Key, m_Entries.begin());
+        ++m_Stats.loads;
+    }
+
+    TextureRef ResourceManager::loadTexture(const std::string& path, const TextureLoadOptions& options)
+    {
+        uint64_t optionsKey = Core::HashCombine(options.mips.key(), options.flip ? 1 : 0);
+        std::string key = MakeKey("texture", CanonicalPath(path), optionsKey);
+        if (auto existing = find(key))
+            return std::static_pointer_cast<Resource<Renderer::GL::Texture2D>>(existing);
+
+        auto resource = std::make_shared<Resource<Renderer::GL::Texture2D>>();
+        resource->m_Key = key;
+        insert(resource);
+
+        PendingTexture pending;
+        pending.resource = resource;
+        pending.chain = m_Pool.submit([path, options]() -> std::unique_ptr<Image::MipChain> {
+            Image::DecodedImage image;
+            auto chain = std::make_unique<Image::MipChain>();
+            if (!Image::Loader::Decode(path, image, options.flip) ||
+                !Image::BuildMipChain(image.pixels.get(), image.width, image.height, image.channels, *chain, options.mips))
+                return nullptr;
+            return chain;
+        });
+        m_PendingTextures.push_back(std::move(pending));
+        return resource;
+    }
+
+    ShaderRef ResourceManager::loadShader(const std::string& vertexPath, const std::string& fragmentPath,
+                                          const Renderer::GL::ShaderConfig& config)
+    {
+        std::string key = MakeKey("shader", CanonicalPath(vertexPath) + "|" + CanonicalPath(fragmentPath),
+                                  HashShaderConfig(config));
+        if (auto existing = find(key))
+            return std::static_pointer_cast<Resource<Renderer::GL::Shader>>(existing);
+
+        auto resource = std::make_shared<Resource<Renderer::GL::Shader>>();
+        resource->m_Key = key;
+        resource->m_Object = std::make_shared<Renderer::GL::Shader>(vertexPath, fragmentPath, config);
+        insert(resource);
+
+        m_PendingShaders.push_back(resource);
+        finishShaders();
+        return resource;
+    }
+
+    ModelRef ResourceManager::loadModel(const std::string& path, const ModelConfig& config)
+    {
+        std::string key = MakeKey("model", CanonicalPath(path), Model::ComputeOptionsKey(config));
+        if (auto existing = find(key))
+            return std::static_pointer_cast<Resource<AsyncModel>>(existing);
+
+        auto resource = std::make_shared<Resource<AsyncModel>>();
+        resource->m_Key = key;
+        resource->m_Object = m_ModelLoader.load(path, config);
+        insert(resource);
+
+        m_PendingModels.push_back(resource);
+        return resource;
+    }
+
+    void ResourceManager::update(const UploadBudget& uploadBudget)
+    {
+        size_t uploaded = uploadTextures(uploadBudget);
+
+        UploadBudget remaining = uploadBudget;
+        remaining.maxBytes = uploadBudget.maxBytes > uploaded ? uploadBudget.maxBytes - uploaded : 0;
+        m_ModelLoader.processUploads(remaining);
+
+        finishShaders();
+        finishModels();
+        updateUsage();
+        evict(false);
+    }
+
+    size_t ResourceManager::evictUnused()
+    {
+        size_t evicted = evict(true);
+        updateUsage();
+        return evicted;
+    }
+
+    bool ResourceManager::hasPendingLoads() const
+    {
+        return !m_PendingTextures.empty() || !m_PendingShaders.empty() || !m_PendingModels.empty();
+    }
+
+    size_t ResourceManager::uploadTextures(const UploadBudget& uploadBudget)
+    {
+        auto start = Clock::now();
+        size_t uploaded = 0;
+
+        for (size_t i = 0; i < m_PendingTextures.size();)
+        {
+            PendingTexture& pending = m_PendingTextures[i];
+            if (pending.chain.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                ++i;
+                continue;
+            }
+
+            // At least one texture per call so loading keeps making progress
+            double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (uploaded > 0 && (uploaded >= uploadBudget.maxBytes || elapsedMs >= uploadBudget.maxMilliseconds))
+                break;
+
+            Resource<Renderer::GL::Texture2D>& resource = *pending.resource;
+            std::unique_ptr<Image::MipChain> chain = pending.chain.get();
+            auto texture = std::make_shared<Renderer::GL::Texture2D>();
+            if (chain && Image::Loader::UploadMipChain(*texture, *chain))
+            {
+                resource.m_Object = std::move(texture);
+                resource.m_GpuBytes = chain->sizeBytes();
+                resource.m_State.store(ResourceState::Ready);
+                uploaded += chain->sizeBytes();
+            }
+            else
+            {
+                std::cerr << "ResourceManager: failed to load " << resource.m_Key << "\n";
+                resource.m_State.store(ResourceState::Failed);
+                ++m_Stats.failed;
+            }
+
+            std::swap(pending, m_PendingTextures.back());
+            m_PendingTextures.pop_back();
+        }
+        return uploaded;
+    }
+
+    void ResourceManager::finishShaders()
+    {
+        for (size_t i = 0; i < m_PendingShaders.size();)
+        {
+            Resource<Renderer::GL::Shader>& resource = *m_PendingShaders[i];
+            Renderer::GL::Shader& shader = *resource.m_Object;
+            if (!shader.poll())
+            {
+                ++i;
+                continue;
+            }
+
+            if (shader.isLinked())
+            {
+                // The driver's program binary is the closest portable estimate of its memory
+                GLint binaryLength = 0;
+                glGetProgramiv(shader.getID(), GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+                resource.m_GpuBytes = static_cast<size_t>(std::max(binaryLength, 0));
+                resource.m_State.store(ResourceState::Ready);
+            }
+            else
+            {
+                resource.m_Object.reset();
+                resource.m_State.store(ResourceState::Failed);
+                ++m_Stats.failed;
+            }
+
+            std::swap(m_PendingShaders[i], m_PendingShaders.back());
+            m_PendingShaders.pop_back();
+        }
+    }
+
+    void ResourceManager::finishModels()
+    {
+        for (size_t i = 0; i < m_PendingModels.size();)
+        {
+            Resource<AsyncModel>& resource = *m_PendingModels[i];
+            ModelLoadState state = resource.m_Object->getState();
+            if (state == ModelLoadState::Loading || state == ModelLoadState::Uploading)
+            {
+                ++i;
+                continue;
+            }
+
+            std::shared_ptr<Model> model = resource.m_Object->waitForModel();
+            if (state == ModelLoadState::Ready && model)
+            {
+                resource.m_CpuBytes = ModelCpuBytes(*model);
+                resource.m_GpuBytes = ModelGpuBytes(*model);
+                resource.m_State.store(ResourceState::Ready);
+            }
+            else
+            {
+                std::cerr << "ResourceManager: failed to load " << resource.m_Key << "\n";
+                resource.m_State.store(ResourceState::Failed);
+                ++m_Stats.failed;
+            }
+
+            std::swap(m_PendingModels[i], m_PendingModels.back());
+            m_PendingModels.pop_back();
+        }
+    }
+
+    void ResourceManager::updateUsage()
+    {
+        m_Stats.resident = m_Entries.size();
+        m_Stats.referenced = 0;
+        m_Stats.cpuBytes = 0;
+        m_Stats.gpuBytes = 0;
+        for (const std::shared_ptr<ResourceBase>& resource : m_Entries)
+        {
+            // The lookup list holds one reference, pending loads another
+            if (resource.use_count() > 1 && resource->getState() != ResourceState::Loading)
+                ++m_Stats.referenced;
+            m_Stats.cpuBytes += resource->m_CpuBytes;
+            m_Stats.gpuBytes += resource->m_GpuBytes;
+        }
+    }
+
+    size_t ResourceManager::evict(bool all)
+    {
+        size_t evicted = 0;
+        auto erase = [&](EntryList::iterator it) {
+            const std::shared_ptr<ResourceBase>& resource = *it;
+            m_Stats.cpuBytes -= resource->m_CpuBytes;
+            m_Stats.gpuBytes -= resource->m_GpuBytes;
+            m_Lookup.erase(resource->m_Key);
+            return m_Entries.erase(it);
+        };
+        auto unused = [](const std::shared_ptr<ResourceBase>& resource) {
+            return resource.use_count() == 1 && resource->getState() != ResourceState::Loading;
+        };
+
+        // Failed loads are dropped once released, so a later request retries
+        for (auto it = m_Entries.begin(); it != m_Entries.end();)
+            it = unused(*it) && (*it)->isFailed() ? erase(it) : std::next(it);
+
+        auto overBudget = [&]() {
+            return m_Stats.cpuBytes > m_Budget.cpuBytes || m_Stats.gpuBytes > m_Budget.gpuBytes;
+        };
+        for (auto it = m_Entries.end(); it != m_Entries.begin() && (all || overBudget());)
+        {
+            --it;
+            if (unused(*it))
+            {
+                it = erase(it);
+                ++evicted;
+            }
+        }
+
+        m_Stats.evictions += evicted;
+        m_Stats.resident = m_Entries.size();
+        return evicted;
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "../NyxAPI.h"
+#include "../Core/ThreadPool.h"
+#include "../Image/ImageLoader.h"
+#include "../ModelLoaders/AsyncModelLoader.h"
+#include "../Renderer/GL/Shader.h"
+#include "../Renderer/GL/Texture2D.h"
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Nyx
+{
+    enum class ResourceState
+    {
+        Loading,    // Decoding, importing or uploading
+        Ready,
+        Failed
+    };
+
+    // Usage above which update() evicts unreferenced resources
+    struct NYX_API ResourceBudget
+    {
+        size_t cpuBytes = 512ull * 1024 * 1024;
+        size_t gpuBytes = 1024ull * 1024 * 1024;
+    };
+
+    struct NYX_API ResourceStats
+    {
+        size_t requests = 0;
+        size_t hits = 0;          // Requests answered by a resident resource
+        size_t coalesced = 0;     // Requests that joined a load already in flight
+        size_t loads = 0;         // Requests that started a load
+        size_t failed = 0;
+        size_t evictions = 0;
+        size_t resident = 0;      // Cached resources, loading ones included
+        size_t referenced = 0;    // Of those, held by at least one handle outside the manager
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+    };
+
+    struct NYX_API TextureLoadOptions
+    {
+        bool flip = true;
+        // The chain is built on the CPU (see Image/MipBuilder.h); maxLevels = 1 for no mips
+        Image::MipBuildOptions mips;
+    };
+
+    // State shared by every cached resource
+    class NYX_API ResourceBase
+    {
+    public:
+        virtual ~ResourceBase() = default;
+
+        inline ResourceState getState() const { return m_State.load(); }
+        inline bool isReady() const { return m_State.load() == ResourceState::Ready; }
+        inline bool isFailed() const { return m_State.load() == ResourceState::Failed; }
+        // Canonical path(s) plus a hash of the load options
+        inline const std::string& getKey() const { return m_Key; }
+        inline size_t getCpuBytes() const { return m_CpuBytes; }
+        inline size_t getGpuBytes() const { return m_GpuBytes; }
+
+    protected:
+        friend class ResourceManager;
+
+        std::string m_Key;
+        std::atomic<ResourceState> m_State{ ResourceState::Loading };
+        size_t m_CpuBytes = 0;
+        size_t m_GpuBytes = 0;
+    };
+
+    template <typename T>
+    class Resource : public ResourceBase
+    {
+    public:
+        // Textures and shaders: nullptr until ready. Models: the AsyncModel exists right away and
+        // streams its meshes in.
+        inline T* get() const { return m_Object.get(); }
+        inline T* operator->() const { return m_Object.get(); }
+
+    private:
+        friend class ResourceManager;
+
+        std::shared_ptr<T> m_Object;
+    };
+
+    using TextureRef = std::shared_ptr<Resource<Renderer::GL::Texture2D>>;
+    using ShaderRef = std::shared_ptr<Resource<Renderer::GL::Shader>>;
+    using ModelRef = std::shared_ptr<Resource<AsyncModel>>;
+
+    /**
+     * Shared cache of textures, shaders and models. A request is keyed by the canonical file path(s)
+     * plus its options, so every model or material that names the same file gets the same object:
+     *
+     *     Nyx::ResourceManager resources({ 256 << 20, 512 << 20 });
+     *     Nyx::TextureRef albedo = resources.loadTexture("assets/brick.png");
+     *     Nyx::ShaderRef lit = resources.loadShader("shaders/lit.vert", "shaders/lit.frag");
+     *     Nyx::ModelRef level = resources.loadModel("assets/level.fbx");
+     *     while (!window.windowClosed()) {
+     *         resources.update();                     // GL thread, once per frame
+     *         if (albedo->isReady()) item.textures[0] = albedo->get();
+     *     }
+     *
+     * Handles are reference counted. A resource nobody holds stays cached, so loading it again is
+     * free, until update() needs its memory: unreferenced resources are then evicted least recently
+     * requested first until CPU and GPU usage fit the budget. Resources still referenced are never
+     * evicted, even over budget.
+     *
+     * Texture decodes and model imports run on the pool; a request for a resource still loading
+     * returns the handle of that load. Every method must be called on the GL thread.
+     */
+    class NYX_API ResourceManager
+    {
+    public:
+        ResourceManager(const ResourceBudget& budget = {}, Core::ThreadPool& pool = Core::ThreadPool::GetShared());
+        ResourceManager(const ResourceManager&) = delete;
+        ResourceManager& operator=(const ResourceManager&) = delete;
+
+        TextureRef loadTexture(const std::string& path, const TextureLoadOptions& options = {});
+        // Compiled on the calling thread; ShaderConfig::deferLink shaders stay loading until linked
+        ShaderRef loadShader(const std::string& vertexPath, const std::string& fragmentPath,
+                             const Renderer::GL::ShaderConfig& config = {});
+        ModelRef loadModel(const std::string& path, const ModelConfig& config = {});
+
+        // Uploads decoded textures and model meshes within the budget, finishes deferred shader
+        // links, updates usage and evicts what no longer fits.
+        void update(const UploadBudget& uploadBudget = {});
+        // Frees every unreferenced resource, whatever the budget. Returns the number evicted.
+        size_t evictUnused();
+        bool hasPendingLoads() const;
+
+        inline void setBudget(const ResourceBudget& budget) { m_Budget = budget; }
+        inline const ResourceBudget& getBudget() const { return m_Budget; }
+        inline const ResourceStats& getStats() const { return m_Stats; }
+
+        // Absolute, normalized path with symlinks resolved where the file exists
+        static std::string CanonicalPath(const std::string& path);
+
+    private:
+        using EntryList = std::list<std::shared_ptr<ResourceBase>>;
+
+        struct PendingTexture
+        {
+            std::shared_ptr<Resource<Renderer::GL::Texture2D>> resource;
+            std::future<std::unique_ptr<Image::MipChain>> chain;
+        };
+
+        // Existing resource for key, moved to the front of the LRU list, or nullptr
+        std::shared_ptr<ResourceBase> find(const std::string& key);
+        void insert(const std::shared_ptr<ResourceBase>& resource);
+        size_t uploadTextures(const UploadBudget& uploadBudget);
+        void finishShaders();
+        void finishModels();
+        void updateUsage();
+        size_t evict(bool all);
+
+    private:
+        ResourceBudget m_Budget;
+        Core::ThreadPool& m_Pool;
+        AsyncModelLoader m_ModelLoader;
+
+        EntryList m_Entries;  // Most recently requested first
+        std::unordered_map<std::string, EntryList::iterator> m_Lookup;
+
+        std::vector<PendingTexture> m_PendingTextures;
+        std::vector<std::shared_ptr<Resource<Renderer::GL::Shader>>> m_PendingShaders;
+        std::vector<std::shared_ptr<Resource<AsyncModel>>> m_PendingModels;
+
+        ResourceStats m_Stats;
+    };
+}